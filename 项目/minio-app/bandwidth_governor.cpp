@@ -0,0 +1,103 @@
+#include "bandwidth_governor.h"
+
+#include <algorithm>
+#include <cstdlib>  // std::strtod
+
+namespace {
+
+const double MB = 1024.0 * 1024.0;
+const double BURST_SECONDS = 0.05;          // 桶容量对应的时长
+const double MIN_CAPACITY = 64 * 1024;      // 低速率时桶容量的下限，约为curl一次发送的大小
+const std::chrono::milliseconds PRIORITY_RECHECK(10);  // 让位给高优先级时的重新检查间隔
+
+}  // namespace
+
+TokenBucket::TokenBucket(uint64_t bytesPerSecond)
+    : rate_(bytesPerSecond),
+      capacity_(std::max(MIN_CAPACITY, bytesPerSecond * BURST_SECONDS)),
+      tokens_(capacity_),
+      lastRefill_(std::chrono::steady_clock::now()) {}
+
+void TokenBucket::Refill(std::chrono::steady_clock::time_point now) {
+    double elapsed = std::chrono::duration<double>(now - lastRefill_).count();
+    tokens_ = std::min(capacity_, tokens_ + elapsed * rate_);
+    lastRefill_ = now;
+}
+
+bool TokenBucket::HigherClassWaiting(TrafficClass trafficClass) const {
+    for (int i = 0; i < static_cast<int>(trafficClass); ++i) {
+        if (waiting_[i] > 0) {
+            return true;
+        }
+    }
+    return false;
+}
+
+void TokenBucket::Consume(size_t bytes, TrafficClass trafficClass) {
+    if (rate_ == 0 || bytes == 0) {
+        return;
+    }
+    size_t& waiting = waiting_[static_cast<int>(trafficClass)];
+    std::unique_lock<std::mutex> lock(mutex_);
+    waiting++;
+    while (true) {
+        Refill(std::chrono::steady_clock::now());
+        if (tokens_ >= 0 && !HigherClassWaiting(trafficClass)) {
+            break;
+        }
+        if (tokens_ < 0) {
+            // 睡到欠额按速率还清；其他调用者取走令牌时会提前唤醒重新检查
+            tokensReady_.wait_for(lock, std::chrono::duration<double>(-tokens_ / rate_));
+        } else {
+            tokensReady_.wait_for(lock, PRIORITY_RECHECK);
+        }
+    }
+    // 数据已经（或即将）发出，整笔扣除；欠账由之后的调用者睡眠偿还
+    tokens_ -= static_cast<double>(bytes);
+    waiting--;
+    lock.unlock();
+    tokensReady_.notify_all();
+}
+
+void BandwidthGovernor::Transfer::Consume(size_t bytes) {
+    bucket_.Consume(bytes);
+    governor_.global_.Consume(bytes, trafficClass_);
+}
+
+minio::http::ProgressFunction BandwidthGovernor::Transfer::UploadMeter() {
+    auto metered = std::make_shared<size_t>(0);
+    return [this, metered](minio::http::ProgressFunctionArgs args) {
+        size_t sent = static_cast<size_t>(args.uploaded_bytes);
+        if (sent < *metered) {
+            *metered = 0;
+        }
+        if (sent > *metered) {
+            Consume(sent - *metered);
+            *metered = sent;
+        }
+        return true;
+    };
+}
+
+bool BandwidthGovernor::ParseRate(const std::string& text, uint64_t& bytesPerSecond) {
+    char* end = nullptr;
+    double megabytes = std::strtod(text.c_str(), &end);
+    if (text.empty() || *end != '\0' || megabytes < 0) {
+        return false;
+    }
+    bytesPerSecond = static_cast<uint64_t>(megabytes * MB);
+    return true;
+}
+
+bool BandwidthGovernor::ParseClass(const std::string& name, TrafficClass& trafficClass) {
+    if (name == "interactive") {
+        trafficClass = TrafficClass::kInteractive;
+    } else if (name == "bulk") {
+        trafficClass = TrafficClass::kBulk;
+    } else if (name == "background") {
+        trafficClass = TrafficClass::kBackground;
+    } else {
+        return false;
+    }
+    return true;
+}
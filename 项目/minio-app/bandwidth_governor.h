@@ -0,0 +1,102 @@
+#pragma once
+
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <miniocpp/client.h>  // MinIO C++ SDK主要头文件
+
+/**
+ * 令牌桶带宽控制
+ *
+ * 功能说明：
+ * 1. 两级令牌桶：进程级全局桶限制所有传输的总带宽，每个传输（一个对象的上传或下载）
+ *    还可以有自己的桶，其下所有并发分块请求共享
+ * 2. 按SDK进度回调/数据回调报告的增量字节计量，粒度是curl的一次发送/接收（几十KB），
+ *    而不是整个分块：5MB分块不会先整块突发再长时间停顿
+ * 3. 令牌允许欠账：数据已经发出后才扣令牌，下一次计量时睡眠直到欠额还清；
+ *    桶容量只有约50ms的流量，空闲后恢复传输时的突发很小
+ * 4. 三个优先级：全局桶的令牌优先分给高优先级的等待者，交互式请求（如单张图片上传）
+ *    在批量任务占满带宽时仍能立即拿到令牌；低优先级在高优先级持续占满时会被饿死
+ *
+ * 限速只在本进程内生效：批量上传和交互上传在不同进程时，应给批量进程设置全局限速。
+ */
+enum class TrafficClass {
+    kInteractive = 0,  // 交互式，延迟敏感
+    kBulk = 1,         // 批量上传下载
+    kBackground = 2,   // 后台任务，只用剩余带宽
+};
+
+class TokenBucket {
+public:
+    // bytesPerSecond为0表示不限速
+    explicit TokenBucket(uint64_t bytesPerSecond);
+
+    TokenBucket(const TokenBucket&) = delete;
+    TokenBucket& operator=(const TokenBucket&) = delete;
+
+    // 扣除bytes个令牌：桶处于欠账或有更高优先级的等待者时先睡眠；可在任意线程调用
+    void Consume(size_t bytes, TrafficClass trafficClass = TrafficClass::kBulk);
+
+    uint64_t Rate() const { return rate_; }
+
+private:
+    static constexpr int CLASS_COUNT = 3;
+
+    void Refill(std::chrono::steady_clock::time_point now);
+    bool HigherClassWaiting(TrafficClass trafficClass) const;
+
+    const uint64_t rate_;
+    const double capacity_;  // 桶容量，即空闲后最多允许的突发字节数
+
+    std::mutex mutex_;
+    std::condition_variable tokensReady_;
+    double tokens_;  // 可为负，表示欠账
+    std::chrono::steady_clock::time_point lastRefill_;
+    size_t waiting_[CLASS_COUNT] = {};  // 各优先级正在等待的调用数
+};
+
+class BandwidthGovernor {
+public:
+    // 一次传输的限速句柄：先过自己的桶，再按优先级过全局桶；可被多个分块线程同时使用
+    class Transfer {
+    public:
+        Transfer(BandwidthGovernor& governor, TrafficClass trafficClass, uint64_t bytesPerSecond)
+            : governor_(governor), trafficClass_(trafficClass), bucket_(bytesPerSecond) {}
+
+        void Consume(size_t bytes);
+
+        // 供PutObjectArgs/UploadPartArgs使用的进度回调：按已发送字节的增量计量；
+        // 已发送字节变小说明SDK开始了新的请求（重试或下一个分块），从0重新计
+        minio::http::ProgressFunction UploadMeter();
+
+    private:
+        BandwidthGovernor& governor_;
+        const TrafficClass trafficClass_;
+        TokenBucket bucket_;
+    };
+
+    // globalBytesPerSecond为0表示总带宽不限
+    explicit BandwidthGovernor(uint64_t globalBytesPerSecond) : global_(globalBytesPerSecond) {}
+
+    BandwidthGovernor(const BandwidthGovernor&) = delete;
+    BandwidthGovernor& operator=(const BandwidthGovernor&) = delete;
+
+    // bytesPerSecond为0表示该传输不单独限速；返回的句柄不能比governor存活更久
+    std::unique_ptr<Transfer> NewTransfer(TrafficClass trafficClass, uint64_t bytesPerSecond = 0) {
+        return std::make_unique<Transfer>(*this, trafficClass, bytesPerSecond);
+    }
+
+    uint64_t GlobalRate() const { return global_.Rate(); }
+
+    // 解析以MB/s为单位的速率（可带小数），0表示不限；无法识别返回false
+    static bool ParseRate(const std::string& text, uint64_t& bytesPerSecond);
+    // 解析"interactive"/"bulk"/"background"，无法识别返回false
+    static bool ParseClass(const std::string& name, TrafficClass& trafficClass);
+
+private:
+    TokenBucket global_;
+};
@@ -0,0 +1,181 @@
+#include "buffer_pool.h"
+
+#include <algorithm>
+#include <cstdlib>   // std::aligned_alloc, std::free
+#include <new>       // std::bad_alloc
+#include <sys/mman.h>
+
+namespace {
+
+const size_t KB = 1024;
+const size_t MB = 1024 * 1024;
+
+// 固定的容量级别，从小到大
+const size_t CLASS_SIZES[] = {64 * KB, 256 * KB, 1 * MB,  2 * MB,  4 * MB,
+                              8 * MB,  16 * MB,  32 * MB, 64 * MB, 128 * MB};
+// 不小于该容量的内存块直接mmap：释放时整块还给内核，不留在malloc的堆里推高RSS
+const size_t MMAP_THRESHOLD = 1 * MB;
+
+}  // namespace
+
+BufferPool& BufferPool::Instance() {
+    static BufferPool pool;
+    return pool;
+}
+
+BufferPool::~BufferPool() {
+    Trim();
+}
+
+size_t BufferPool::SlabSize(size_t capacity) {
+    for (size_t classSize : CLASS_SIZES) {
+        if (capacity <= classSize) {
+            return classSize;
+        }
+    }
+    // 超过最大级别：按大页大小取整，不进入空闲列表
+    return (capacity + HUGE_PAGE_SIZE - 1) / HUGE_PAGE_SIZE * HUGE_PAGE_SIZE;
+}
+
+size_t BufferPool::ClassIndex(size_t size) {
+    static_assert(sizeof(CLASS_SIZES) / sizeof(CLASS_SIZES[0]) == CLASS_COUNT,
+                  "容量级别数与CLASS_COUNT不一致");
+    for (size_t i = 0; i < CLASS_COUNT; ++i) {
+        if (CLASS_SIZES[i] == size) {
+            return i;
+        }
+    }
+    return CLASS_COUNT;
+}
+
+void BufferPool::SetHugePages(bool enabled) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    hugePages_ = enabled;
+}
+
+void BufferPool::SetIdleLimits(size_t totalBytes, size_t classBytes) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    maxIdleBytes_ = totalBytes;
+    maxIdleClassBytes_ = classBytes;
+}
+
+BufferPool::Slab BufferPool::Acquire(size_t capacity) {
+    size_t size = SlabSize(capacity);
+    size_t index = ClassIndex(size);
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stats_.acquires++;
+        if (index < CLASS_COUNT && !idle_[index].empty()) {
+            Slab slab = idle_[index].back();
+            idle_[index].pop_back();
+            idleBytes_[index] -= slab.size;
+            stats_.hits++;
+            stats_.bytesIdle -= slab.size;
+            stats_.bytesInUse += slab.size;
+            stats_.peakBytesInUse = std::max(stats_.peakBytesInUse, stats_.bytesInUse);
+            return slab;
+        }
+    }
+
+    // 未命中：在锁外分配，几MB的mmap/分配不阻塞其他线程借还
+    Slab slab = Allocate(size);
+    std::lock_guard<std::mutex> lock(mutex_);
+    stats_.bytesReserved += slab.size;
+    stats_.bytesInUse += slab.size;
+    stats_.peakBytesInUse = std::max(stats_.peakBytesInUse, stats_.bytesInUse);
+    return slab;
+}
+
+void BufferPool::Release(const Slab& slab) {
+    if (slab.data == nullptr) {
+        return;
+    }
+    size_t index = ClassIndex(slab.size);
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stats_.bytesInUse -= slab.size;
+        if (index < CLASS_COUNT && idleBytes_[index] + slab.size <= maxIdleClassBytes_ &&
+            stats_.bytesIdle + slab.size <= maxIdleBytes_) {
+            idle_[index].push_back(slab);
+            idleBytes_[index] += slab.size;
+            stats_.bytesIdle += slab.size;
+            return;
+        }
+        stats_.bytesReserved -= slab.size;
+        stats_.slabsFreed++;
+    }
+    Free(slab);  // 超出空闲上限或最大级别：在锁外释放
+}
+
+void BufferPool::Trim() {
+    std::array<std::vector<Slab>, CLASS_COUNT> idle;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        idle.swap(idle_);
+        idleBytes_.fill(0);
+        stats_.bytesReserved -= stats_.bytesIdle;
+        stats_.bytesIdle = 0;
+    }
+    for (const auto& slabs : idle) {
+        for (const Slab& slab : slabs) {
+            Free(slab);
+        }
+    }
+}
+
+BufferPool::Stats BufferPool::GetStats() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return stats_;
+}
+
+BufferPool::Slab BufferPool::Allocate(size_t size) {
+    bool hugePages;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        hugePages = hugePages_;
+    }
+
+    Slab slab;
+    slab.size = size;
+    if (size >= MMAP_THRESHOLD) {
+        bool huge = hugePages && size % HUGE_PAGE_SIZE == 0;
+        void* p = MAP_FAILED;
+        if (huge) {
+            // 优先使用预留的大页（vm.nr_hugepages），没有预留时退回透明大页
+            p = ::mmap(nullptr, size, PROT_READ | PROT_WRITE,
+                       MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+            if (p != MAP_FAILED) {
+                std::lock_guard<std::mutex> lock(mutex_);
+                stats_.hugePageSlabs++;
+            }
+        }
+        if (p == MAP_FAILED) {
+            p = ::mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+            if (p == MAP_FAILED) {
+                throw std::bad_alloc();
+            }
+            if (huge) {
+                ::madvise(p, size, MADV_HUGEPAGE);
+            }
+        }
+        slab.data = static_cast<char*>(p);
+        slab.mapped = true;
+        return slab;
+    }
+
+    // 64KB、256KB两个小级别：aligned_alloc要求大小是对齐值的整数倍，各级别都满足；
+    // 不清零内存，避免无用的写
+    slab.data = static_cast<char*>(std::aligned_alloc(PAGE_SIZE, size));
+    if (slab.data == nullptr) {
+        throw std::bad_alloc();
+    }
+    return slab;
+}
+
+void BufferPool::Free(const Slab& slab) {
+    if (slab.mapped) {
+        ::munmap(slab.data, slab.size);
+    } else {
+        std::free(slab.data);
+    }
+}
@@ -0,0 +1,98 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <vector>
+
+/**
+ * 进程级缓冲区池
+ *
+ * 功能说明：
+ * 1. 分块、压缩/加密块、读文件等大缓冲区都从这里借出、用完归还，按容量分级复用，
+ *    多个上传先后进行或同时进行时不再反复向堆申请几MB的内存，避免碎片和RSS持续上涨
+ * 2. 固定的几个容量级别：64KB、256KB、1MB，2MB起按2的幂到128MB；申请的容量向上取到
+ *    最近的级别，分块大小各不相同时也落在少数几个级别上，归还的内存块能被下一次借出复用。
+ *    级别之间的差额只是虚拟地址：没有写入的页不占物理内存
+ * 3. 超过最大级别的申请按2MB取整单独分配，归还时直接释放，不进入空闲列表
+ * 4. 空闲内存有上限：每个级别和全部级别各有一个空闲字节数上限，归还时超过上限的内存块
+ *    直接释放，一次大上传结束后池不会一直持有它的峰值内存
+ * 5. 内存块按页对齐，满足O_DIRECT对缓冲区地址的要求；1MB及以上的内存块都用匿名mmap分配，
+ *    释放时直接还给内核，只有64KB、256KB两个小级别走aligned_alloc
+ * 6. 可选大页：2MB整数倍的内存块先尝试MAP_HUGETLB预留的大页，失败时退回普通匿名映射
+ *    并以MADV_HUGEPAGE提示透明大页，减少TLB缺失
+ * 7. 统计借出次数、复用命中率、池占用内存、借出内存的峰值和超出上限后释放的内存块数
+ */
+class BufferPool {
+public:
+    static constexpr size_t PAGE_SIZE = 4096;
+    static constexpr size_t HUGE_PAGE_SIZE = 2 * 1024 * 1024;
+    static constexpr size_t DEFAULT_MAX_IDLE_BYTES = 512 * 1024 * 1024;        // 全部级别
+    static constexpr size_t DEFAULT_MAX_IDLE_CLASS_BYTES = 256 * 1024 * 1024;  // 单个级别
+
+    // 借出的内存块；size为实际容量（不小于申请的容量）
+    struct Slab {
+        char* data = nullptr;
+        size_t size = 0;
+        bool mapped = false;  // 以mmap分配（释放时munmap，1MB及以上），否则为aligned_alloc
+    };
+
+    struct Stats {
+        uint64_t acquires = 0;        // 借出次数
+        uint64_t hits = 0;            // 其中复用空闲内存块的次数
+        uint64_t hugePageSlabs = 0;   // 以大页分配的内存块数
+        uint64_t slabsFreed = 0;      // 归还时因超出空闲上限或超出最大级别而释放的内存块数
+        size_t bytesReserved = 0;     // 池持有的内存（借出的和空闲的）
+        size_t bytesIdle = 0;         // 其中空闲的内存
+        size_t bytesInUse = 0;        // 当前借出的内存
+        size_t peakBytesInUse = 0;    // 借出内存的峰值
+
+        double HitRate() const {
+            return acquires == 0 ? 0.0 : static_cast<double>(hits) / acquires;
+        }
+    };
+
+    static BufferPool& Instance();
+
+    BufferPool(const BufferPool&) = delete;
+    BufferPool& operator=(const BufferPool&) = delete;
+
+    // 只影响之后新分配的内存块，须在开始上传前设置
+    void SetHugePages(bool enabled);
+
+    // 空闲内存上限：totalBytes为全部级别合计，classBytes为单个级别；只影响之后的归还
+    void SetIdleLimits(size_t totalBytes, size_t classBytes);
+
+    // 借出容量不小于capacity的内存块，内存不清零；分配失败抛出std::bad_alloc
+    Slab Acquire(size_t capacity);
+    void Release(const Slab& slab);
+
+    // 释放所有空闲内存块
+    void Trim();
+
+    Stats GetStats() const;
+
+    // 申请capacity字节时实际分配的容量
+    static size_t SlabSize(size_t capacity);
+
+private:
+    static constexpr size_t CLASS_COUNT = 10;  // 64KB、256KB、1MB、2MB ... 128MB
+
+    BufferPool() = default;
+    ~BufferPool();
+
+    // size所在的容量级别；不是某个级别的大小时返回CLASS_COUNT
+    static size_t ClassIndex(size_t size);
+
+    Slab Allocate(size_t size);
+    static void Free(const Slab& slab);
+
+    mutable std::mutex mutex_;
+    bool hugePages_ = false;
+    size_t maxIdleBytes_ = DEFAULT_MAX_IDLE_BYTES;
+    size_t maxIdleClassBytes_ = DEFAULT_MAX_IDLE_CLASS_BYTES;
+    std::array<std::vector<Slab>, CLASS_COUNT> idle_;  // 每个级别的空闲内存块
+    std::array<size_t, CLASS_COUNT> idleBytes_{};      // 每个级别的空闲字节数
+    Stats stats_;
+};
@@ -0,0 +1,204 @@
+#include "bulk_uploader.h"
+
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>     // open
+#include <unistd.h>    // read, close
+
+#include "direct_put.h"
+#include "mapped_file.h"
+#include "part_planner.h"
+
+namespace {
+
+// 把整个文件读入dest，最多读取capacity字节；bytesRead为实际读到的字节数
+bool ReadWholeFile(const std::string& path, char* dest, size_t capacity, size_t& bytesRead,
+                   std::string& error) {
+    bytesRead = 0;
+    int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        error = "无法打开文件: " + std::string(std::strerror(errno));
+        return false;
+    }
+    while (bytesRead < capacity) {
+        ssize_t n = ::read(fd, dest + bytesRead, capacity - bytesRead);
+        if (n < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            error = "读取文件失败: " + std::string(std::strerror(errno));
+            ::close(fd);
+            return false;
+        }
+        if (n == 0) {
+            break;
+        }
+        bytesRead += static_cast<size_t>(n);
+    }
+    ::close(fd);
+    return true;
+}
+
+}  // namespace
+
+BulkUploader::BulkUploader(const MinioConfig& config, std::string bucket, const Options& options)
+    : config_(config),
+      bucket_(std::move(bucket)),
+      options_(options),
+      retryBudget_(options.retryBudget),
+      governor_(options.totalRate),
+      startTime_(std::chrono::steady_clock::now()) {
+    size_t workers = options_.workers == 0 ? 1 : options_.workers;
+    for (size_t i = 0; i < workers; ++i) {
+        connections_.push_back(std::make_unique<MinioConnection>(config_));
+        partWorkers_.emplace_back();
+    }
+    // 排队容量取线程数的几倍：遍历目录的线程不必等每个文件上传完才继续
+    pool_ = std::make_unique<ThreadPool>(workers, workers * 4);
+}
+
+BulkUploader::~BulkUploader() {
+    Wait();
+}
+
+void BulkUploader::Submit(const std::string& path, const std::string& objectName, size_t size) {
+    pool_->Submit([this, path, objectName, size](size_t workerIndex) {
+        UploadOne(workerIndex, path, objectName, size);
+    });
+}
+
+void BulkUploader::Wait() {
+    pool_->Wait();
+    if (!finished_) {
+        endTime_ = std::chrono::steady_clock::now();
+        finished_ = true;
+    }
+}
+
+void BulkUploader::UploadOne(size_t workerIndex, const std::string& path,
+                             const std::string& objectName, size_t size) {
+    // 对象数单独计数：大文件的分块由MultipartUploader按分块计入，两种单位不混在一起
+    if (progress_ != nullptr) {
+        progress_->ObjectStarted();
+    }
+
+    // 每个对象一个限速句柄：大文件的并发分块共享单对象限额
+    std::unique_ptr<BandwidthGovernor::Transfer> bandwidth;
+    if (options_.totalRate > 0 || options_.objectRate > 0) {
+        bandwidth = governor_.NewTransfer(options_.trafficClass, options_.objectRate);
+    }
+
+    size_t bytes = 0;
+    std::string error;
+    bool large = size >= options_.multipartThreshold;
+    bool ok = large ? UploadLarge(workerIndex, path, objectName, bandwidth.get(), bytes, error)
+                    : UploadSmall(workerIndex, path, objectName, size, bandwidth.get(), bytes, error);
+    if (ok) {
+        objectsUploaded_++;
+        bytesUploaded_ += bytes;
+        if (large) {
+            multipartObjects_++;
+        }
+    } else {
+        objectsFailed_++;
+        std::lock_guard<std::mutex> lock(failuresMutex_);
+        failures_.push_back(path + ": " + error);
+    }
+
+    if (progress_ != nullptr) {
+        // 大文件的字节已由MultipartUploader实时计入进度
+        if (ok && !large) {
+            progress_->AddBytesUploaded(bytes);
+        }
+        progress_->ObjectFinished();
+    }
+}
+
+bool BulkUploader::UploadSmall(size_t workerIndex, const std::string& path,
+                               const std::string& objectName, size_t size,
+                               BandwidthGovernor::Transfer* bandwidth, size_t& bytes,
+                               std::string& error) {
+    // 每个文件从缓冲区池借一块，上传结束即归还：大小相近的文件落在同一容量级别上直接复用，
+    // 偶尔出现的大文件用完后按池的空闲上限释放，不会被工作线程一直占着
+    PartBuffer buffer(size);
+    if (!ReadWholeFile(path, buffer.Data(), size, bytes, error)) {
+        return false;
+    }
+
+    MinioConnection& connection = *connections_[workerIndex];
+    minio::s3::PutObjectResponse resp;
+    // 请求体直接引用缓冲区，重试时原样重发，不经过SDK的5MB分块缓冲区
+    minio::s3::PutObjectApiArgs args;
+    args.bucket = bucket_;
+    args.object = objectName;
+    args.data = std::string_view(buffer.Data(), bytes);
+    if (bandwidth != nullptr) {
+        args.progressfunc = bandwidth->UploadMeter();
+    }
+    return RetryCall(options_.retryPolicy, retryBudget_, objectName, [&] {
+        return PutObjectDirect(connection.Client(), args);
+    }, resp, error);
+}
+
+bool BulkUploader::UploadLarge(size_t workerIndex, const std::string& path,
+                               const std::string& objectName,
+                               BandwidthGovernor::Transfer* bandwidth, size_t& bytes,
+                               std::string& error) {
+    MappedFile mappedFile;
+    if (!mappedFile.Open(path)) {
+        error = mappedFile.LastError();
+        return false;
+    }
+    size_t totalSize = mappedFile.Size();
+
+    // 分块直接引用映射区，上传器不需要暂存缓冲区
+    PartPlanner planner(totalSize, options_.partConcurrency, options_.partConcurrency,
+                        options_.memoryBudget);
+    // 只有本工作线程使用自己的这一组分块线程，无需加锁
+    std::unique_ptr<PartWorkerPool>& partWorkers = partWorkers_[workerIndex];
+    if (partWorkers == nullptr) {
+        partWorkers = std::make_unique<PartWorkerPool>(config_, options_.partConcurrency,
+                                                       options_.partConcurrency);
+    }
+    MultipartUploader uploader(*connections_[workerIndex], *partWorkers, bucket_, objectName, 0, 0);
+    uploader.SetRetryPolicy(options_.retryPolicy, &retryBudget_);
+    uploader.SetProgress(progress_);
+    uploader.SetBandwidth(bandwidth);
+    if (!uploader.Begin()) {
+        error = uploader.LastError();
+        return false;
+    }
+
+    unsigned int partNumber = 1;
+    for (size_t offset = 0; offset < totalSize; partNumber++) {
+        size_t partSize = planner.NextPartSize(offset, partNumber);
+        std::string_view partData = mappedFile.View(offset, partSize);
+        mappedFile.Prefetch(offset, partSize * 2);
+        offset += partData.size();
+        if (!uploader.SubmitPart(partNumber, partData)) {
+            break;
+        }
+    }
+    if (!uploader.Complete()) {
+        error = uploader.LastError();
+        return false;
+    }
+    bytes = totalSize;
+    return true;
+}
+
+BulkUploader::Stats BulkUploader::GetStats() const {
+    Stats stats;
+    stats.objectsUploaded = objectsUploaded_;
+    stats.objectsFailed = objectsFailed_;
+    stats.multipartObjects = multipartObjects_;
+    stats.bytesUploaded = bytesUploaded_;
+    auto end = finished_ ? endTime_ : std::chrono::steady_clock::now();
+    stats.elapsedSeconds = std::chrono::duration<double>(end - startTime_).count();
+    return stats;
+}
+
+std::vector<std::string> BulkUploader::Failures() const {
+    std::lock_guard<std::mutex> lock(failuresMutex_);
+    return failures_;
+}
@@ -0,0 +1,122 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "bandwidth_governor.h"
+#include "minio_connection.h"
+#include "multipart_uploader.h"
+#include "part_buffer.h"
+#include "progress_reporter.h"
+#include "retry_policy.h"
+#include "thread_pool.h"
+
+/**
+ * 批量对象上传器
+ *
+ * 功能说明：
+ * 1. 一个进程内上传大量文件：固定数量的工作线程从共享有界队列取文件，
+ *    每个工作线程持有一个MinIO客户端并在所有文件间复用，不再每个文件建一次连接和凭证
+ * 2. 小文件（< multipartThreshold）读入从BufferPool借出的缓冲区，一次PutObject发出
+ * 3. 大文件映射后交给MultipartUploader并发上传分块；每个工作线程第一次遇到大文件时建立一组
+ *    分块上传线程和连接，之后该线程上的所有大文件复用，控制请求借用工作线程自己的连接
+ * 4. 单个文件失败只记录错误，不影响其他文件；PutObject和分块请求都按RetryPolicy重试，
+ *    整个批次（包括每个大文件的分块）共享同一个重试预算
+ * 5. 统计对象数、字节数，给出 对象/秒 和 MB/秒
+ * 6. 可选带宽控制：整个批次共用一个全局令牌桶，每个对象还可以单独限速，
+ *    默认以kBulk优先级让位给同进程内的交互式流量
+ *
+ * 使用方式：
+ *   BulkUploader bulk(config, "bucket", options);
+ *   bulk.Submit("/data/a.jpg", "images/a.jpg", size);  // 队列满时阻塞
+ *   ...
+ *   bulk.Wait();
+ */
+class BulkUploader {
+public:
+    struct Options {
+        size_t workers = 16;                               // 工作线程数（同时上传的对象数）
+        size_t multipartThreshold = 16 * 1024 * 1024;      // 不小于该大小的文件使用Multipart Upload
+        size_t partConcurrency = 4;                        // 单个大文件同时上传的分块数
+        size_t memoryBudget = 256 * 1024 * 1024;           // 单个大文件的分块规划内存预算
+        RetryPolicy retryPolicy;                           // 单个请求的重试策略
+        size_t retryBudget = 1000;                         // 整个批次允许的重试总次数
+        uint64_t totalRate = 0;                            // 整个批次的带宽上限（字节/秒），0表示不限
+        uint64_t objectRate = 0;                           // 单个对象的带宽上限（字节/秒），0表示不限
+        TrafficClass trafficClass = TrafficClass::kBulk;   // 批次流量的优先级
+    };
+
+    struct Stats {
+        size_t objectsUploaded = 0;    // 上传成功的对象数
+        size_t objectsFailed = 0;      // 上传失败的对象数
+        size_t multipartObjects = 0;   // 其中使用Multipart Upload的对象数
+        size_t bytesUploaded = 0;      // 上传成功的字节数
+        double elapsedSeconds = 0;     // 从构造到当前/Wait()结束的耗时
+
+        double ObjectsPerSecond() const {
+            return elapsedSeconds > 0 ? objectsUploaded / elapsedSeconds : 0;
+        }
+        double MegabytesPerSecond() const {
+            return elapsedSeconds > 0 ? bytesUploaded / 1024.0 / 1024.0 / elapsedSeconds : 0;
+        }
+    };
+
+    BulkUploader(const MinioConfig& config, std::string bucket, const Options& options);
+    ~BulkUploader();
+
+    BulkUploader(const BulkUploader&) = delete;
+    BulkUploader& operator=(const BulkUploader&) = delete;
+
+    // 可选，须在第一次Submit()之前设置；按对象更新进度
+    void SetProgress(ProgressReporter* progress) { progress_ = progress; }
+
+    // 把一个文件加入上传队列；队列满时阻塞（反压，避免遍历目录远远跑在上传前面）
+    void Submit(const std::string& path, const std::string& objectName, size_t size);
+
+    // 等待所有已提交的文件上传结束
+    void Wait();
+
+    Stats GetStats() const;
+    // 失败的文件及原因，每项为"路径: 错误信息"
+    std::vector<std::string> Failures() const;
+
+private:
+    void UploadOne(size_t workerIndex, const std::string& path, const std::string& objectName,
+                   size_t size);
+    // size为遍历目录时得到的文件大小；文件之后变长时只上传前size字节
+    // bandwidth为nullptr表示不限速
+    bool UploadSmall(size_t workerIndex, const std::string& path, const std::string& objectName,
+                     size_t size, BandwidthGovernor::Transfer* bandwidth, size_t& bytes,
+                     std::string& error);
+    bool UploadLarge(size_t workerIndex, const std::string& path, const std::string& objectName,
+                     BandwidthGovernor::Transfer* bandwidth, size_t& bytes, std::string& error);
+
+    const MinioConfig config_;
+    const std::string bucket_;
+    const Options options_;
+    std::vector<std::unique_ptr<MinioConnection>> connections_;  // 每个工作线程一个
+    std::vector<std::unique_ptr<PartWorkerPool>> partWorkers_;   // 每个工作线程一组，按需创建
+    RetryBudget retryBudget_;
+    BandwidthGovernor governor_;
+    ProgressReporter* progress_ = nullptr;
+
+    std::atomic<size_t> objectsUploaded_{0};
+    std::atomic<size_t> objectsFailed_{0};
+    std::atomic<size_t> multipartObjects_{0};
+    std::atomic<size_t> bytesUploaded_{0};
+    std::chrono::steady_clock::time_point startTime_;
+    std::chrono::steady_clock::time_point endTime_;
+    std::atomic<bool> finished_{false};
+
+    mutable std::mutex failuresMutex_;
+    std::vector<std::string> failures_;
+
+    // 线程池最后声明、最先析构：工作线程退出前上面的成员都必须有效
+    std::unique_ptr<ThreadPool> pool_;
+};
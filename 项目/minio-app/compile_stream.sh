@@ -54,7 +54,11 @@ g++ -std=c++17 \
     -I"$INCLUDE_DIR" \
     -L"$LIB_DIR" \
     -o minio_stream \
-    minio_stream.cpp \
+    minio_stream.cpp multipart_uploader.cpp part_reader.cpp mapped_file.cpp file_reader.cpp \
+    part_planner.cpp s3_multipart_api.cpp upload_journal.cpp stream_source.cpp \
+    progress_reporter.cpp content_hasher.cpp dedup_index.cpp \
+    part_hasher.cpp bandwidth_governor.cpp part_compressor.cpp \
+    parallel_chunk_source.cpp part_encryptor.cpp buffer_pool.cpp \
     -lminiocpp -lpugixml -lINIReader -linih -lcurlpp -lcurl -lz -lssl -lcrypto -lpthread -ldl
 
 if [ $? -eq 0 ]; then
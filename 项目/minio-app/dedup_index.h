@@ -0,0 +1,57 @@
+#pragma once
+
+#include <cstddef>
+#include <string>
+
+#include "minio_connection.h"
+
+/**
+ * "秒传"去重索引
+ *
+ * 功能说明：
+ * 1. 索引存放在目标存储桶内：对象 <prefix><内容摘要> 的内容是第一次上传该内容时的对象名，
+ *    多台机器、多个进程共享同一份索引，不需要额外的数据库
+ * 2. 经过本索引上传的对象带用户元数据 content-sha256（见DIGEST_METADATA_KEY）；Lookup()命中后
+ *    StatObject核对原对象仍存在、大小一致且该元数据等于查询的摘要，不符时（对象已删除或被
+ *    覆盖为其他内容）删除这条过期索引并按未命中处理
+ * 3. 命中时用CopyObject在服务端复制出新对象，数据不经过本机网络；复制以核对时的ETag为条件，
+ *    核对之后原对象被覆盖时服务端拒绝复制
+ * 4. 上传成功后Register()写入索引；同一内容并发上传时后写者覆盖，索引仍指向一个有效对象
+ * 5. 上传期间源文件被修改时对象上的摘要不可信：RemoveStale()删除该摘要的索引，
+ *    Retag()把对象的摘要元数据改成实际上传内容的摘要（未知时删除该元数据）
+ */
+class DedupIndex {
+public:
+    static constexpr const char* DEFAULT_PREFIX = ".dedup/sha256/";
+    // 用户元数据键（不含x-amz-meta-前缀），取值为对象内容的SHA-256十六进制串
+    static constexpr const char* DIGEST_METADATA_KEY = "content-sha256";
+
+    DedupIndex(MinioConnection& connection, std::string bucket,
+               std::string prefix = DEFAULT_PREFIX);
+
+    // 查找内容摘要对应的已有对象：命中返回true并写入objectName和核对时的etag；
+    // 未命中返回false且error为空，请求出错返回false并写入error
+    bool Lookup(const std::string& digest, size_t size, std::string& objectName, std::string& etag,
+                std::string& error);
+
+    // 记录 内容摘要 -> 对象名
+    bool Register(const std::string& digest, const std::string& objectName, std::string& error);
+
+    // 服务端复制source为target，返回新对象的ETag；source的ETag不再是sourceEtag时复制失败
+    bool CopyTo(const std::string& source, const std::string& sourceEtag, const std::string& target,
+                std::string& etag, std::string& error);
+
+    // 删除摘要对应的索引（指向已删除或已变化的对象）；失败只影响下次查询的效率，不报告
+    void RemoveStale(const std::string& digest);
+
+    // 服务端把对象复制到自身并替换用户元数据：content-sha256改为digest，digest为空时删除；
+    // 对象的其他用户元数据不保留
+    bool Retag(const std::string& objectName, const std::string& digest, std::string& error);
+
+private:
+    std::string IndexKey(const std::string& digest) const { return prefix_ + digest; }
+
+    MinioConnection& connection_;
+    const std::string bucket_;
+    const std::string prefix_;
+};
@@ -0,0 +1,31 @@
+#pragma once
+
+#include <cstddef>
+#include <string_view>
+#include <miniocpp/client.h>  // MinIO C++ SDK主要头文件
+
+/**
+ * 不拷贝数据的单次PutObject
+ *
+ * Client::PutObject(PutObjectArgs)只接受输入流：即使对象只有几KB，SDK也会先分配一个
+ * 5MB的分块缓冲区，把流中的数据拷贝进去再发送。BaseClient::PutObject(PutObjectApiArgs)
+ * 直接以args.data（string_view）作为请求体，数据从调用方的缓冲区或映射区原样发出。
+ *
+ * 注意：
+ * 1. 该接口不分块，对象不能超过单次PutObject的上限MAX_DIRECT_PUT_SIZE
+ * 2. 不会像Client::PutObject那样合并user_metadata：用户元数据以"x-amz-meta-"前缀
+ *    写进args.headers；Content-Type缺省时这里补上
+ * 3. args.data指向的内存必须在调用返回前保持有效
+ */
+constexpr size_t MAX_DIRECT_PUT_SIZE = size_t(5) * 1024 * 1024 * 1024;  // S3单次PutObject上限 5GB
+
+inline minio::s3::PutObjectResponse PutObjectDirect(minio::s3::Client& client,
+                                                    minio::s3::PutObjectApiArgs args) {
+    if (!args.headers.Contains("Content-Type")) {
+        args.headers.Add("Content-Type", args.content_type.empty() ? "application/octet-stream"
+                                                                   : args.content_type);
+    }
+    // Client声明的PutObject(PutObjectArgs)遮蔽了基类的同名重载，通过基类引用调用
+    minio::s3::BaseClient& base = client;
+    return base.PutObject(args);
+}
@@ -0,0 +1,140 @@
+#include "download_journal.h"
+
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>     // open
+#include <fstream>     // 读取日志
+#include <sstream>
+#include <unistd.h>    // write, fdatasync, close, unlink
+
+namespace {
+
+const char* JOURNAL_MAGIC = "minio-download-journal 1";
+
+}  // namespace
+
+DownloadJournal::~DownloadJournal() {
+    Close();
+}
+
+bool DownloadJournal::Load(const std::string& path, State& state) {
+    std::ifstream in(path);
+    if (!in.is_open()) {
+        return false;
+    }
+
+    std::string line;
+    if (!std::getline(in, line) || line != JOURNAL_MAGIC) {
+        return false;
+    }
+
+    state = State();
+    while (std::getline(in, line)) {
+        size_t space = line.find(' ');
+        if (space == std::string::npos) {
+            continue;  // 崩溃时写了一半的行
+        }
+        std::string key = line.substr(0, space);
+        std::string value = line.substr(space + 1);
+        try {
+            if (key == "bucket") {
+                state.bucket = value;
+            } else if (key == "object") {
+                state.object = value;  // 对象名可能含空格，取整行剩余部分
+            } else if (key == "etag") {
+                state.etag = value;
+            } else if (key == "object_size") {
+                state.objectSize = std::stoull(value);
+            } else if (key == "range_size") {
+                state.rangeSize = std::stoull(value);
+            } else if (key == "range") {
+                std::istringstream fields(value);
+                uint64_t offset = 0;
+                size_t length = 0;
+                if (fields >> offset >> length) {
+                    state.ranges[offset] = length;
+                }
+            }
+        } catch (const std::exception&) {
+            continue;  // 数字字段被截断，忽略该行
+        }
+    }
+    return !state.bucket.empty() && !state.object.empty() && !state.etag.empty() &&
+           state.rangeSize > 0;
+}
+
+bool DownloadJournal::Create(const std::string& path, const State& header) {
+    Close();
+    path_ = path;
+    fd_ = ::open(path.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+    if (fd_ < 0) {
+        lastError_ = "无法创建续传日志 " + path + ": " + std::strerror(errno);
+        return false;
+    }
+
+    std::ostringstream text;
+    text << JOURNAL_MAGIC << "\n"
+         << "bucket " << header.bucket << "\n"
+         << "object " << header.object << "\n"
+         << "etag " << header.etag << "\n"
+         << "object_size " << header.objectSize << "\n"
+         << "range_size " << header.rangeSize << "\n";
+    std::lock_guard<std::mutex> lock(mutex_);
+    return WriteDurably(text.str());
+}
+
+bool DownloadJournal::OpenForAppend(const std::string& path) {
+    Close();
+    path_ = path;
+    fd_ = ::open(path.c_str(), O_WRONLY | O_APPEND | O_CLOEXEC);
+    if (fd_ < 0) {
+        lastError_ = "无法打开续传日志 " + path + ": " + std::strerror(errno);
+        return false;
+    }
+    // 上次崩溃可能留下不完整的最后一行，先补一个换行，保证新记录独占一行
+    std::lock_guard<std::mutex> lock(mutex_);
+    return WriteDurably("\n");
+}
+
+bool DownloadJournal::RecordRange(uint64_t offset, size_t length) {
+    std::string line = "range " + std::to_string(offset) + " " + std::to_string(length) + "\n";
+    std::lock_guard<std::mutex> lock(mutex_);
+    return WriteDurably(line);
+}
+
+void DownloadJournal::Remove() {
+    Close();
+    if (!path_.empty()) {
+        ::unlink(path_.c_str());
+    }
+}
+
+bool DownloadJournal::WriteDurably(const std::string& text) {
+    if (fd_ < 0) {
+        return false;
+    }
+    size_t written = 0;
+    while (written < text.size()) {
+        ssize_t n = ::write(fd_, text.data() + written, text.size() - written);
+        if (n < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            lastError_ = std::string("写续传日志失败: ") + std::strerror(errno);
+            return false;
+        }
+        written += static_cast<size_t>(n);
+    }
+    if (::fdatasync(fd_) != 0) {
+        lastError_ = std::string("续传日志落盘失败: ") + std::strerror(errno);
+        return false;
+    }
+    return true;
+}
+
+void DownloadJournal::Close() {
+    if (fd_ >= 0) {
+        ::close(fd_);
+        fd_ = -1;
+    }
+}
@@ -0,0 +1,75 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <mutex>
+#include <string>
+
+/**
+ * 分段下载断点续传日志
+ *
+ * 功能说明：
+ * 1. 在输出文件旁的sidecar文件（<输出文件>.download-journal）中记录对象的ETag、大小和范围大小
+ * 2. 每个范围的数据落盘后追加一行"range 偏移 长度"并fdatasync，进程崩溃也不会丢失
+ * 3. 重启时读回日志：ETag与服务端当前一致才跳过已完成的范围，其余范围带If-Match重新请求；
+ *    对象已被覆盖时调用方丢弃日志和输出文件，从头下载
+ *
+ * 文件格式（文本，逐行追加）：
+ *   minio-download-journal 1
+ *   bucket <bucket>
+ *   object <object>
+ *   etag <ETag>
+ *   object_size <对象大小>
+ *   range_size <范围大小>
+ *   range <偏移> <长度>
+ *   ...
+ * 崩溃时最后一行可能不完整，读取时忽略无法解析的行。
+ */
+class DownloadJournal {
+public:
+    struct State {
+        std::string bucket;
+        std::string object;
+        std::string etag;
+        uint64_t objectSize = 0;
+        size_t rangeSize = 0;
+        std::map<uint64_t, size_t> ranges;  // 偏移 -> 长度，已落盘的范围
+    };
+
+    DownloadJournal() = default;
+    ~DownloadJournal();
+
+    DownloadJournal(const DownloadJournal&) = delete;
+    DownloadJournal& operator=(const DownloadJournal&) = delete;
+
+    static std::string PathFor(const std::string& outputFile) {
+        return outputFile + ".download-journal";
+    }
+
+    // 读取已有日志；文件不存在或头部不完整返回false
+    static bool Load(const std::string& path, State& state);
+
+    // 新建日志（覆盖旧文件）并写入头部
+    bool Create(const std::string& path, const State& header);
+
+    // 打开已有日志，继续追加范围记录
+    bool OpenForAppend(const std::string& path);
+
+    // 记录一个数据已落盘的范围，可在多个下载线程中并发调用
+    bool RecordRange(uint64_t offset, size_t length);
+
+    // 下载完成后删除日志
+    void Remove();
+
+    const std::string& LastError() const { return lastError_; }
+
+private:
+    bool WriteDurably(const std::string& text);
+    void Close();
+
+    std::string path_;
+    int fd_ = -1;
+    std::mutex mutex_;
+    std::string lastError_;
+};
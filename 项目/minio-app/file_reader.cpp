@@ -0,0 +1,348 @@
+#include "file_reader.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <cstring>
+#include <fcntl.h>      // open, O_DIRECT
+#include <sys/stat.h>   // fstat
+#include <thread>
+#include <unistd.h>     // pread, close
+#include <vector>
+
+#ifdef MINIO_APP_HAVE_LIBURING
+#include <liburing.h>
+#endif
+
+namespace {
+
+// ==================== pread后端 ====================
+class PreadFileReader : public FileReader {
+public:
+    bool ReadAt(char* dest, size_t length, uint64_t offset, size_t& bytesRead) override {
+        bytesRead = 0;
+        size_t request = RequestLength(length);
+        while (bytesRead < request) {
+            ssize_t n = ::pread(fd_, dest + bytesRead, request - bytesRead,
+                                static_cast<off_t>(offset + bytesRead));
+            if (n < 0) {
+                if (errno == EINTR) {
+                    continue;
+                }
+                lastError_ = std::string("pread失败: ") + std::strerror(errno);
+                return false;
+            }
+            if (n == 0) {
+                break;  // 文件末尾
+            }
+            bytesRead += static_cast<size_t>(n);
+        }
+        bytesRead = std::min(bytesRead, length);
+        return true;
+    }
+
+    const char* Name() const override { return "pread"; }
+};
+
+#ifdef MINIO_APP_HAVE_LIBURING
+// ==================== io_uring后端 ====================
+class UringFileReader : public FileReader {
+public:
+    UringFileReader(size_t queueDepth, size_t ioSize)
+        : queueDepth_(queueDepth == 0 ? 1 : queueDepth),
+          ioSize_(std::max(DIRECT_ALIGNMENT, ioSize / DIRECT_ALIGNMENT * DIRECT_ALIGNMENT)) {}
+
+    ~UringFileReader() override { Close(); }
+
+    bool Init(std::string& error) {
+        int ret = io_uring_queue_init(static_cast<unsigned>(queueDepth_), &ring_, 0);
+        if (ret < 0) {
+            error = std::string("io_uring初始化失败: ") + std::strerror(-ret);
+            return false;
+        }
+        initialized_ = true;
+        return true;
+    }
+
+    bool ReadAt(char* dest, size_t length, uint64_t offset, size_t& bytesRead) override {
+        bytesRead = 0;
+        if (!initialized_) {
+            lastError_ = "io_uring已在之前的错误后关闭";
+            return false;
+        }
+        if (offset >= size_) {
+            return true;
+        }
+
+        // 把[offset, offset+request)拆成ioSize_大小的读请求
+        size_t request = RequestLength(std::min<uint64_t>(length, size_ - offset));
+        chunks_.clear();
+        for (size_t pos = 0; pos < request; pos += ioSize_) {
+            chunks_.push_back({dest + pos, offset + pos, std::min(ioSize_, request - pos), 0, false,
+                               nullptr});
+        }
+
+        size_t next = 0;      // 下一个未提交的请求
+        size_t inflight = 0;  // 在途请求数
+        bool ok = true;
+        while (inflight > 0 || (ok && next < chunks_.size())) {
+            while (ok && inflight < queueDepth_ && next < chunks_.size()) {
+                Queue(next++);
+                inflight++;
+            }
+            std::string submitError;
+            if (!Submit(inflight, submitError)) {
+                // 未被内核接收的请求作废，已提交的取消并等待结束；环的状态不再可信，随后关闭
+                if (ok) {
+                    lastError_ = submitError;
+                }
+                inflight -= DiscardPending();
+                CancelInflight(inflight);
+                Close();
+                return false;
+            }
+
+            io_uring_cqe* cqe = nullptr;
+            int ret = io_uring_wait_cqe(&ring_, &cqe);
+            if (ret == -EINTR) {
+                continue;
+            }
+            if (ret < 0) {
+                // 内核可能仍在写缓冲区：取消在途请求并等它们结束后才能返回，由调用方按读取失败处理
+                lastError_ = std::string("io_uring等待失败: ") + std::strerror(-ret);
+                inflight -= DiscardPending();
+                CancelInflight(inflight);
+                return false;
+            }
+            void* data = io_uring_cqe_get_data(cqe);
+            if (data == CancelTag()) {
+                io_uring_cqe_seen(&ring_, cqe);  // 之前失败时遗留的取消或空操作的完成事件
+                continue;
+            }
+            size_t index = static_cast<size_t>(reinterpret_cast<uintptr_t>(data));
+            int res = cqe->res;
+            io_uring_cqe_seen(&ring_, cqe);
+            inflight--;
+            chunks_[index].queued = false;
+
+            if (res == -EINTR || res == -EAGAIN) {
+                if (ok) {
+                    Queue(index);  // 可重试错误：原样重新提交
+                    inflight++;
+                }
+                continue;
+            }
+            if (res < 0) {
+                // 记录错误，但必须等所有在途请求完成后才能返回，缓冲区仍被内核使用
+                if (ok) {
+                    lastError_ = std::string("io_uring读取失败: ") + std::strerror(-res);
+                }
+                ok = false;
+                continue;
+            }
+
+            Chunk& chunk = chunks_[index];
+            chunk.done += static_cast<size_t>(res);
+            // 短读且未到文件末尾：提交剩余部分
+            if (ok && res > 0 && chunk.done < chunk.length && chunk.offset + chunk.done < size_) {
+                Queue(index);
+                inflight++;
+            }
+        }
+        if (!ok) {
+            return false;
+        }
+
+        for (const Chunk& chunk : chunks_) {
+            bytesRead += chunk.done;
+            if (chunk.done < chunk.length) {
+                break;  // 只统计从offset起连续读到的数据
+            }
+        }
+        bytesRead = std::min(bytesRead, length);
+        return true;
+    }
+
+    const char* Name() const override { return "io_uring"; }
+
+private:
+    struct Chunk {
+        char* dest;
+        uint64_t offset;
+        size_t length;
+        size_t done;  // 已读到的字节数
+        bool queued;  // 是否在途（已排队或已提交）
+        io_uring_sqe* sqe;  // 最近一次排队使用的SQE，提交失败时据此作废
+    };
+
+    // 取消请求的user_data，与读请求的下标区分
+    static void* CancelTag() { return reinterpret_cast<void*>(UINTPTR_MAX); }
+
+    // 提交已排队的请求。内核暂时无法接收（-EAGAIN/-EBUSY）时：有已提交的请求在途就返回true，
+    // 由调用方先回收完成事件再在下一轮提交；没有可回收的请求则短暂等待后重试，
+    // 重试耗尽或遇到其他错误时返回false并写入error
+    bool Submit(size_t inflight, std::string& error) {
+        const unsigned int MAX_BUSY_RETRIES = 100;
+        unsigned int busyRetries = 0;
+        while (!pending_.empty()) {
+            int ret = io_uring_submit(&ring_);
+            if (ret > 0) {
+                // 内核按顺序接收SQE，未接收的留在提交队列中，下次提交时继续
+                size_t accepted = std::min(static_cast<size_t>(ret), pending_.size());
+                pending_.erase(pending_.begin(), pending_.begin() + accepted);
+                continue;
+            }
+            if (ret == -EINTR) {
+                continue;
+            }
+            if (ret == 0 || ret == -EAGAIN || ret == -EBUSY) {
+                if (inflight > pending_.size()) {
+                    return true;
+                }
+                if (++busyRetries <= MAX_BUSY_RETRIES) {
+                    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+                    continue;
+                }
+            }
+            error = std::string("io_uring提交失败: ") +
+                    std::strerror(ret < 0 ? -ret : EAGAIN);
+            return false;
+        }
+        return true;
+    }
+
+    // 把还没被内核接收的读请求改成空操作，之后即使被提交也不会再写调用方的缓冲区；
+    // 返回作废的请求数
+    size_t DiscardPending() {
+        for (size_t index : pending_) {
+            io_uring_prep_nop(chunks_[index].sqe);
+            io_uring_sqe_set_data(chunks_[index].sqe, CancelTag());
+            chunks_[index].queued = false;
+        }
+        size_t discarded = pending_.size();
+        pending_.clear();
+        return discarded;
+    }
+
+    // 关闭环（内核在销毁环时取消剩余请求），之后ReadAt都返回失败
+    void Close() {
+        if (initialized_) {
+            io_uring_queue_exit(&ring_);
+            initialized_ = false;
+        }
+    }
+
+    // io_uring等待或提交失败后调用：对已提交的读请求提交取消并逐个等待完成，确认内核不再写
+    // 调用方的缓冲区；取消提交失败时只等待请求自然结束，多次等待仍失败时关闭环
+    void CancelInflight(size_t inflight) {
+        for (size_t i = 0; i < chunks_.size(); ++i) {
+            if (!chunks_[i].queued) {
+                continue;
+            }
+            // 作废的请求仍占着提交队列，取消请求与它们合计不超过队列深度
+            io_uring_sqe* sqe = io_uring_get_sqe(&ring_);
+            if (sqe == nullptr) {
+                break;
+            }
+            io_uring_prep_cancel(sqe, reinterpret_cast<void*>(static_cast<uintptr_t>(i)), 0);
+            io_uring_sqe_set_data(sqe, CancelTag());
+        }
+        // 提交失败时取消请求留在队列里，环的状态不再可信，最后关闭
+        bool submitted = io_uring_submit(&ring_) >= 0;
+
+        const unsigned int MAX_WAIT_FAILURES = 5;
+        unsigned int failures = 0;
+        while (inflight > 0 && failures < MAX_WAIT_FAILURES) {
+            __kernel_timespec timeout = {1, 0};
+            io_uring_cqe* cqe = nullptr;
+            int ret = io_uring_wait_cqe_timeout(&ring_, &cqe, &timeout);
+            if (ret < 0) {
+                if (ret != -EINTR) {
+                    failures++;
+                }
+                continue;
+            }
+            void* data = io_uring_cqe_get_data(cqe);
+            io_uring_cqe_seen(&ring_, cqe);
+            if (data != CancelTag()) {
+                chunks_[reinterpret_cast<uintptr_t>(data)].queued = false;
+                inflight--;  // 读请求结束（完成或被取消）
+            }
+        }
+        if (inflight > 0 || !submitted) {
+            Close();
+        }
+    }
+
+    void Queue(size_t index) {
+        Chunk& chunk = chunks_[index];
+        io_uring_sqe* sqe = io_uring_get_sqe(&ring_);  // 在途数不超过队列深度，必有空位
+        io_uring_prep_read(sqe, fd_, chunk.dest + chunk.done,
+                           static_cast<unsigned>(chunk.length - chunk.done),
+                           chunk.offset + chunk.done);
+        io_uring_sqe_set_data(sqe, reinterpret_cast<void*>(static_cast<uintptr_t>(index)));
+        chunk.queued = true;
+        chunk.sqe = sqe;
+        pending_.push_back(index);
+    }
+
+    const size_t queueDepth_;
+    const size_t ioSize_;
+    io_uring ring_{};
+    bool initialized_ = false;
+    std::vector<Chunk> chunks_;
+    std::vector<size_t> pending_;  // 已排队、尚未被内核接收的请求，按排队顺序
+};
+#endif
+
+}  // namespace
+
+FileReader::~FileReader() {
+    if (fd_ >= 0) {
+        ::close(fd_);
+    }
+}
+
+std::unique_ptr<FileReader> FileReader::Create(ReaderBackend backend, size_t queueDepth,
+                                               size_t ioSize, std::string& warning) {
+    if (backend == ReaderBackend::kUring) {
+#ifdef MINIO_APP_HAVE_LIBURING
+        auto reader = std::make_unique<UringFileReader>(queueDepth, ioSize);
+        if (reader->Init(warning)) {
+            return reader;
+        }
+        warning += "，退回pread";
+#else
+        (void)queueDepth;
+        (void)ioSize;
+        warning = "编译时未找到liburing，io_uring后端不可用，退回pread";
+#endif
+    }
+    return std::make_unique<PreadFileReader>();
+}
+
+bool FileReader::Open(const std::string& path, bool direct) {
+    direct_ = false;
+    if (direct) {
+        fd_ = ::open(path.c_str(), O_RDONLY | O_CLOEXEC | O_DIRECT);
+        direct_ = fd_ >= 0;  // tmpfs等不支持O_DIRECT时open返回EINVAL，下面退回普通读取
+    }
+    if (fd_ < 0) {
+        fd_ = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    }
+    if (fd_ < 0) {
+        lastError_ = "无法打开文件 " + path + ": " + std::strerror(errno);
+        return false;
+    }
+
+    struct stat st;
+    if (::fstat(fd_, &st) != 0) {
+        lastError_ = "无法获取文件大小 " + path + ": " + std::strerror(errno);
+        return false;
+    }
+    size_ = static_cast<size_t>(st.st_size);
+    if (!direct_) {
+        ::posix_fadvise(fd_, 0, 0, POSIX_FADV_SEQUENTIAL);  // 普通读取时提示内核加大预读
+    }
+    return true;
+}
@@ -0,0 +1,65 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+
+/**
+ * 可插拔的文件读取后端
+ *
+ * 功能说明：
+ * 1. FileReader统一"按偏移读取一段数据到调用方缓冲区"的接口，分块读取线程不关心底层实现
+ * 2. pread后端：可移植，每个分块一次大块pread（不再是每32KB一次系统调用）
+ * 3. io_uring后端：把一个分块拆成若干ioSize大小的读请求，同时保持queueDepth个在途，
+ *    NVMe上可以用较深的队列跑满磁盘带宽（需编译时找到liburing）
+ * 4. 可选O_DIRECT：绕过页缓存，数据由设备直接DMA到分块缓冲区
+ *
+ * O_DIRECT要求：dest按4KB对齐、offset按4KB对齐，且dest容量不小于length向上取整到4KB；
+ * PartBuffer满足这些条件。文件系统不支持O_DIRECT时自动退回普通读取。
+ */
+enum class ReaderBackend {
+    kPread,  // 可移植的pread
+    kUring,  // io_uring，多请求并发
+};
+
+class FileReader {
+public:
+    static constexpr size_t DIRECT_ALIGNMENT = 4096;
+
+    virtual ~FileReader();
+
+    FileReader(const FileReader&) = delete;
+    FileReader& operator=(const FileReader&) = delete;
+
+    // 创建指定后端；io_uring不可用时退回pread，并把原因写入warning
+    static std::unique_ptr<FileReader> Create(ReaderBackend backend, size_t queueDepth,
+                                              size_t ioSize, std::string& warning);
+
+    // 打开文件；direct为true时尝试O_DIRECT
+    bool Open(const std::string& path, bool direct);
+
+    // 从offset开始读取最多length字节到dest，bytesRead为实际读到的字节数
+    // （读到文件末尾时小于length）；出错返回false，错误信息见LastError()
+    virtual bool ReadAt(char* dest, size_t length, uint64_t offset, size_t& bytesRead) = 0;
+
+    virtual const char* Name() const = 0;
+
+    size_t Size() const { return size_; }
+    bool Direct() const { return direct_; }
+    const std::string& LastError() const { return lastError_; }
+
+protected:
+    FileReader() = default;
+
+    // O_DIRECT模式下读取长度需要按块对齐，向上取整；文件末尾的短读由内核截断
+    size_t RequestLength(size_t length) const {
+        return direct_ ? (length + DIRECT_ALIGNMENT - 1) / DIRECT_ALIGNMENT * DIRECT_ALIGNMENT
+                       : length;
+    }
+
+    int fd_ = -1;
+    size_t size_ = 0;
+    bool direct_ = false;
+    std::string lastError_;
+};
@@ -0,0 +1,78 @@
+#include "mapped_file.h"
+
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>      // open
+#include <sys/mman.h>   // mmap, madvise
+#include <sys/stat.h>   // fstat
+#include <unistd.h>     // close, sysconf
+
+MappedFile::~MappedFile() {
+    Close();
+}
+
+bool MappedFile::Open(const std::string& path) {
+    Close();
+
+    int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        lastError_ = "无法打开文件 " + path + ": " + std::strerror(errno);
+        return false;
+    }
+
+    struct stat st;
+    if (::fstat(fd, &st) != 0) {
+        lastError_ = "无法获取文件大小 " + path + ": " + std::strerror(errno);
+        ::close(fd);
+        return false;
+    }
+    size_ = static_cast<size_t>(st.st_size);
+
+    if (size_ > 0) {
+        void* addr = ::mmap(nullptr, size_, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (addr == MAP_FAILED) {
+            lastError_ = "mmap失败 " + path + ": " + std::strerror(errno);
+            ::close(fd);
+            size_ = 0;
+            return false;
+        }
+        data_ = static_cast<const char*>(addr);
+        // 顺序访问提示失败不影响正确性，忽略返回值
+        ::madvise(addr, size_, MADV_SEQUENTIAL);
+    }
+
+    ::close(fd);  // 映射建立后即可关闭文件描述符，映射仍然有效
+    return true;
+}
+
+void MappedFile::Close() {
+    if (data_ != nullptr) {
+        ::munmap(const_cast<char*>(data_), size_);
+    }
+    data_ = nullptr;
+    size_ = 0;
+}
+
+std::string_view MappedFile::View(size_t offset, size_t length) const {
+    if (offset >= size_) {
+        return std::string_view();
+    }
+    if (length > size_ - offset) {
+        length = size_ - offset;
+    }
+    return std::string_view(data_ + offset, length);
+}
+
+void MappedFile::Prefetch(size_t offset, size_t length) const {
+    if (data_ == nullptr || offset >= size_) {
+        return;
+    }
+    if (length > size_ - offset) {
+        length = size_ - offset;
+    }
+    // madvise要求起始地址按页对齐
+    static const size_t pageSize = static_cast<size_t>(::sysconf(_SC_PAGESIZE));
+    size_t alignedOffset = offset & ~(pageSize - 1);
+    ::madvise(const_cast<char*>(data_) + alignedOffset, length + (offset - alignedOffset),
+              MADV_WILLNEED);
+}
@@ -0,0 +1,45 @@
+#pragma once
+
+#include <cstddef>
+#include <string>
+#include <string_view>
+
+/**
+ * 只读内存映射文件
+ *
+ * 功能说明：
+ * 1. 用mmap把本地文件整体映射到进程地址空间，上传时直接以string_view引用映射区，
+ *    省去read()到用户态缓冲区的拷贝和iostream的缓冲开销
+ * 2. 打开时对整个映射设置MADV_SEQUENTIAL，内核按顺序访问模式加大预读、及时回收已读页
+ * 3. Prefetch()对即将上传的区间发出MADV_WILLNEED，让内核提前把数据读入页缓存
+ *
+ * 空文件不做映射，View()返回空视图。
+ */
+class MappedFile {
+public:
+    MappedFile() = default;
+    ~MappedFile();
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    // 打开并映射文件；失败返回false，错误信息见LastError()
+    bool Open(const std::string& path);
+    void Close();
+
+    const char* Data() const { return data_; }
+    size_t Size() const { return size_; }
+
+    // 映射区中[offset, offset+length)的视图，越界部分被截断
+    std::string_view View(size_t offset, size_t length) const;
+
+    // 提示内核预读[offset, offset+length)
+    void Prefetch(size_t offset, size_t length) const;
+
+    const std::string& LastError() const { return lastError_; }
+
+private:
+    const char* data_ = nullptr;
+    size_t size_ = 0;
+    std::string lastError_;
+};
@@ -0,0 +1,58 @@
+#pragma once
+
+#include <cstddef>
+#include <istream>    // std::istream
+#include <streambuf>  // std::streambuf
+
+/**
+ * 不拷贝数据的内存输入流
+ *
+ * std::istringstream构造时会把字符串整体复制一份；MemoryIStream只把已有内存区间
+ * 设置为streambuf的读取区，读取时直接从原内存取数据。用于把内存缓冲区交给
+ * PutObjectArgs（它只接受std::istream）。
+ *
+ * 注意：流不拥有内存，调用方必须保证缓冲区在流使用期间有效。
+ */
+class MemoryStreamBuf : public std::streambuf {
+public:
+    MemoryStreamBuf(const char* data, size_t size) {
+        // streambuf接口使用非const指针，但读取区只会被读取，不会被写入
+        char* begin = const_cast<char*>(data);
+        setg(begin, begin, begin + size);
+    }
+
+protected:
+    pos_type seekoff(off_type off, std::ios_base::seekdir dir,
+                     std::ios_base::openmode which = std::ios_base::in) override {
+        if (!(which & std::ios_base::in)) {
+            return pos_type(off_type(-1));
+        }
+        off_type base = 0;
+        if (dir == std::ios_base::cur) {
+            base = gptr() - eback();
+        } else if (dir == std::ios_base::end) {
+            base = egptr() - eback();
+        }
+        off_type target = base + off;
+        if (target < 0 || target > egptr() - eback()) {
+            return pos_type(off_type(-1));
+        }
+        setg(eback(), eback() + target, egptr());
+        return pos_type(target);
+    }
+
+    pos_type seekpos(pos_type pos, std::ios_base::openmode which = std::ios_base::in) override {
+        return seekoff(off_type(pos), std::ios_base::beg, which);
+    }
+};
+
+class MemoryIStream : public std::istream {
+public:
+    MemoryIStream(const char* data, size_t size)
+        : std::istream(nullptr), buf_(data, size) {
+        rdbuf(&buf_);
+    }
+
+private:
+    MemoryStreamBuf buf_;
+};
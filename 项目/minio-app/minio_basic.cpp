@@ -1,8 +1,20 @@
+#include <cerrno>
+#include <cstring>
 #include <iostream>
 #include <fstream>
+#include <fcntl.h>     // open，下载输出文件
+#include <unistd.h>    // close, ftruncate
 #include <miniocpp/client.h>
 #include <miniocpp/providers.h>
 
+#include "bandwidth_governor.h"  // 令牌桶带宽控制
+#include "direct_put.h"          // 不拷贝数据的单次PutObject
+#include "mapped_file.h"         // 只读内存映射文件
+#include "memory_istream.h"      // 不拷贝数据的内存输入流
+#include "part_compressor.h"     // zstd流式解压
+#include "part_encryptor.h"      // 客户端AES-256-GCM解密
+#include "write_behind_sink.h"   // 合并写入、后台落盘
+
 /**
  * MinIO C++ 客户端示例程序
  * 
@@ -14,6 +26,14 @@
  * 3. 默认访问地址：http://localhost:9000
  * 4. 默认管理员账号：minioadmin / minioadmin
  * 
+ * 用法：minio_basic [文件路径] [带宽上限MB/s] [密钥文件]
+ * 指定带宽上限时上传和下载都按交互式优先级限速（0表示不限）
+ * 下载时对象带有content-codec: zstd元数据（minio_stream --compress上传）则边接收边解压
+ * 对象带有client-encryption: aes-256-gcm元数据（minio_stream --encrypt-key上传）时
+ * 须提供同一密钥文件，边接收边解密；同时压缩过的对象先解密再解压
+ * 下载的数据先合并进大块缓冲区，由后台线程写入文件，接收回调不等待磁盘；
+ * 输出文件按HEAD得到的对象大小预先fallocate
+ * 
  * 编译时需要链接MinIO C++ SDK：
  * g++ -o minio_app minio.cpp -lminio
  */
@@ -24,9 +44,29 @@ int main(int argc, char *argv[]) {
     std::string filePath = "test-file.txt";
     // ==================== 命令行参数验证 ====================
     // 检查用户是否提供了正确的命令行参数
-    if (argc == 2) {
+    if (argc >= 2) {
         filePath = argv[1];  // 获取要上传的源文件路径
     }
+    // 可选的带宽上限（MB/s），0表示不限
+    uint64_t limitRate = 0;
+    if (argc >= 3 && !BandwidthGovernor::ParseRate(argv[2], limitRate)) {
+        std::cerr << "无效的带宽上限: " << argv[2] << std::endl;
+        return 1;
+    }
+    BandwidthGovernor governor(limitRate);
+    std::unique_ptr<BandwidthGovernor::Transfer> bandwidth;
+    if (limitRate > 0) {
+        bandwidth = governor.NewTransfer(TrafficClass::kInteractive);
+    }
+    // 可选的客户端加密主密钥，下载加密对象时使用
+    std::string masterKey;
+    if (argc >= 4) {
+        std::string keyError;
+        if (!ObjectCipher::LoadKey(argv[3], masterKey, keyError)) {
+            std::cerr << keyError << std::endl;
+            return 1;
+        }
+    }
    
 
     // ==================== MinIO服务器连接配置 ====================
@@ -76,25 +116,39 @@ int main(int argc, char *argv[]) {
     std::cout << "开始上传文件到MinIO..." << std::endl;
     try {
         // 上传文件到MinIO服务器
-        // 使用文件流上传
-        std::ifstream fileStream(filePath, std::ios::binary);
-        if (!fileStream.is_open()) {
-            std::cerr << "无法打开文件: " << filePath << std::endl;
+        // 使用内存映射上传：不超过单次PutObject上限时请求体直接引用映射区，没有任何拷贝；
+        // 更大的文件只能交给Client::PutObject分块，SDK会把每个分块拷贝进自己的缓冲区
+        MappedFile mappedFile;
+        if (!mappedFile.Open(filePath)) {
+            std::cerr << mappedFile.LastError() << std::endl;
             return 1;
         }
         
-        // 获取文件大小
-        fileStream.seekg(0, std::ios::end);
-        long fileSize = fileStream.tellg();
-        fileStream.seekg(0, std::ios::beg);
-        
-        // 创建上传参数
-        minio::s3::PutObjectArgs args(fileStream, fileSize, 0);
-        args.bucket = bucketName;
-        args.object = objectName;
+        // 获取文件大小，并提示内核预读整个文件
+        long fileSize = mappedFile.Size();
+        mappedFile.Prefetch(0, mappedFile.Size());
         
         // 执行上传
-        minio::s3::PutObjectResponse resp = minio.PutObject(args);
+        minio::s3::PutObjectResponse resp;
+        if (mappedFile.Size() <= MAX_DIRECT_PUT_SIZE) {
+            minio::s3::PutObjectApiArgs args;
+            args.bucket = bucketName;
+            args.object = objectName;
+            args.data = std::string_view(mappedFile.Data(), mappedFile.Size());
+            if (bandwidth) {
+                args.progressfunc = bandwidth->UploadMeter();  // 按已发送字节细粒度限速
+            }
+            resp = PutObjectDirect(minio, args);
+        } else {
+            MemoryIStream fileStream(mappedFile.Data(), mappedFile.Size());
+            minio::s3::PutObjectArgs args(fileStream, fileSize, 0);
+            args.bucket = bucketName;
+            args.object = objectName;
+            if (bandwidth) {
+                args.progressfunc = bandwidth->UploadMeter();
+            }
+            resp = minio.PutObject(args);
+        }
         if (!resp) {
             std::cerr << "上传失败: " << resp.Error().String() << std::endl;
             return 1;
@@ -122,7 +176,6 @@ int main(int argc, char *argv[]) {
                 }
             }
         }
-        fileStream.close();
     } catch (const std::exception& e) {
         std::cerr << "上传文件时发生错误: " << e.what() << std::endl;
         std::cerr << "请检查：" << std::endl;
@@ -146,29 +199,133 @@ int main(int argc, char *argv[]) {
         minio::s3::GetObjectArgs args;
         args.bucket = bucketName;
         args.object = objectName;
+
+        // 先查询对象元数据，判断是否需要解密、解压
+        minio::s3::StatObjectArgs statArgs;
+        statArgs.bucket = bucketName;
+        statArgs.object = objectName;
+        minio::s3::StatObjectResponse statResp = minio.StatObject(statArgs);
+        if (!statResp) {
+            std::cerr << "获取对象信息失败: " << statResp.Error().String() << std::endl;
+            return 1;
+        }
+        // 下载固定在查询到的这个版本上：对象在两次请求之间被替换时GetObject返回412，
+        // 而不是把另一个大小不同的对象写进按旧大小预分配的文件
+        args.match_etag = statResp.etag;
+        std::string codec = statResp.user_metadata.GetFront(PartCompressor::CODEC_METADATA_KEY);
+        std::unique_ptr<StreamDecompressor> decompressor;
+        if (codec == PartCompressor::CODEC_ZSTD) {
+            std::cout << "对象以zstd压缩存储，下载时解压" << std::endl;
+            decompressor = std::make_unique<StreamDecompressor>();
+        } else if (!codec.empty()) {
+            std::cerr << "不支持的压缩格式: " << codec << std::endl;
+            return 1;
+        }
+        std::string encryption = statResp.user_metadata.GetFront(ObjectCipher::METADATA_KEY);
+        std::unique_ptr<StreamDecryptor> decryptor;
+        if (encryption == ObjectCipher::ALGORITHM) {
+            if (masterKey.empty()) {
+                std::cerr << "对象在客户端加密存储，需要提供密钥文件" << std::endl;
+                return 1;
+            }
+            std::cout << "对象以AES-256-GCM加密存储，下载时解密" << std::endl;
+            decryptor = std::make_unique<StreamDecryptor>(masterKey);
+        } else if (!encryption.empty()) {
+            std::cerr << "不支持的加密算法: " << encryption << std::endl;
+            return 1;
+        }
         
-        // 创建输出文件流
-        std::ofstream outFile(downloadPath, std::ios::binary);
-        if (!outFile.is_open()) {
+        // 创建输出文件，写入交给后台线程
+        int outFd = ::open(downloadPath.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+        if (outFd < 0) {
             std::cerr << "无法创建输出文件: " << downloadPath << std::endl;
             return 1;
         }
+        // 未压缩、未加密的对象写入的字节数就是对象大小，先一次分配文件空间
+        std::string writerWarning;
+        if (!decompressor && !decryptor &&
+            !WriteBehindSink::Preallocate(outFd, statResp.size, writerWarning)) {
+            std::cerr << writerWarning << std::endl;
+            ::close(outFd);
+            return 1;
+        }
+        auto outSink = std::make_unique<WriteBehindSink>(outFd, WriterBackend::kPwrite, writerWarning);
+        auto closeOutput = [&] {
+            outSink.reset();  // 写线程退出后才能关闭文件
+            ::close(outFd);
+        };
         
         // 设置数据回调函数
-        args.datafunc = [&outFile](minio::http::DataFunctionArgs dataArgs) -> bool {
-            outFile.write(dataArgs.datachunk.c_str(), dataArgs.datachunk.length());
+        // 处理链：接收 -> [解密] -> [解压] -> 写文件，每一级的输出直接交给下一级，不缓存整个对象
+        std::string transformError;
+        uint64_t outPosition = 0;  // 输出文件的写入位置
+        StreamDecryptor::Sink writeFile = [&](const char* data, size_t size) {
+            if (!outSink->Write(outPosition, data, size)) {
+                transformError = outSink->LastError();
+                return false;
+            }
+            outPosition += size;
             return true;
         };
+        StreamDecryptor::Sink plainSink = writeFile;
+        if (decompressor) {
+            plainSink = [&](const char* data, size_t size) {
+                return decompressor->Write(data, size, writeFile, transformError);
+            };
+        }
+        args.datafunc = [&](minio::http::DataFunctionArgs dataArgs) -> bool {
+            if (bandwidth) {
+                bandwidth->Consume(dataArgs.datachunk.length());  // 每收到一块数据计量一次
+            }
+            // 返回false让SDK中止下载
+            if (decryptor) {
+                return decryptor->Write(dataArgs.datachunk.data(), dataArgs.datachunk.length(),
+                                        plainSink, transformError);
+            }
+            return plainSink(dataArgs.datachunk.data(), dataArgs.datachunk.length());
+        };
         
         // 执行下载
         minio::s3::GetObjectResponse resp = minio.GetObject(args);
         if (!resp) {
             std::cerr << "下载失败: " << resp.Error().String() << std::endl;
-            outFile.close();
+            if (!transformError.empty()) {
+                std::cerr << transformError << std::endl;
+            }
+            closeOutput();
+            return 1;
+        }
+        // 最后一条加密记录要到数据全部收到后才能认证，之后才能确认压缩流完整
+        if ((decryptor && !decryptor->Finish(plainSink, transformError)) ||
+            (decompressor && !decompressor->Finish(transformError))) {
+            std::cerr << "下载失败: " << transformError << std::endl;
+            closeOutput();
+            return 1;
+        }
+        if (!outSink->Flush()) {
+            std::cerr << "下载失败: " << outSink->LastError() << std::endl;
+            closeOutput();
             return 1;
         }
+        // 预分配按对象大小扩展了文件，写入的字节少于对象大小时文件尾部会留下一段0
+        if (!decompressor && !decryptor && outPosition != statResp.size) {
+            std::cerr << "下载失败: 收到 " << outPosition << " 字节，对象大小 " << statResp.size
+                      << " 字节" << std::endl;
+            closeOutput();
+            return 1;
+        }
+        if (::ftruncate(outFd, static_cast<off_t>(outPosition)) != 0) {
+            std::cerr << "截断输出文件失败: " << std::strerror(errno) << std::endl;
+            closeOutput();
+            return 1;
+        }
+        WriteBehindSink::Stats writeStats = outSink->GetStats();
+        if (writeStats.stalls > 0) {
+            std::cout << "写缓冲区已满等待: " << writeStats.stalls << " 次，共 "
+                      << writeStats.stallSeconds << " 秒" << std::endl;
+        }
         
-        outFile.close();
+        closeOutput();
         std::cout << "文件下载成功！" << std::endl;
         std::cout << "保存位置: " << downloadPath << std::endl;
     } catch (const std::exception& e) {
@@ -0,0 +1,215 @@
+#include <iostream>      // 标准输入输出流，用于控制台打印
+#include <algorithm>     // std::max
+#include <cstdlib>       // std::strtoul，解析命令行数值参数
+#include <filesystem>    // 递归遍历目录
+#include <getopt.h>      // getopt_long，解析命令行选项
+#include <system_error>  // 遍历目录时的错误码
+
+#include "bandwidth_governor.h"  // 令牌桶带宽控制
+#include "buffer_pool.h"        // 进程级缓冲区池
+#include "bulk_uploader.h"      // 批量对象上传器
+#include "minio_connection.h"   // MinIO连接配置
+#include "part_planner.h"       // MB等分块常量
+#include "progress_reporter.h"  // 异步进度报告
+
+/**
+ * MinIO 批量目录上传程序
+ *
+ * 功能说明：
+ * 1. 递归遍历目录，把每个普通文件上传为 前缀 + 相对路径 的对象
+ * 2. 一个进程处理整个目录：工作线程数个MinIO客户端在所有文件间复用，
+ *    不再每个文件启动一次进程、重新建立连接和凭证
+ * 3. 小文件一次PutObject，大文件（--threshold以上）映射后用Multipart Upload并发上传分块
+ * 4. 输出总对象数、对象/秒和MB/秒；失败的文件单独列出，不中断整个批次
+ * 5. --limit-rate 限制整个批次的总带宽，--object-rate 限制单个对象的带宽，
+ *    按发送进度细粒度计量，避免批量任务占满上行链路
+ * 6. 所有对象的读文件缓冲区和分块缓冲区都从进程级缓冲区池借还，前后对象复用同一批内存；
+ *    --huge-pages 以2MB大页分配分块缓冲区
+ *
+ * 依赖库：
+ * - MinIO C++ SDK - 对象存储操作
+ */
+
+static void PrintUsage(const char* program) {
+    std::cerr << "使用方法: " << program << " [选项] <directory>" << std::endl;
+    std::cerr << "  -j, --jobs N          同时上传的对象数（默认16）" << std::endl;
+    std::cerr << "  -b, --bucket NAME     目标存储桶（默认video）" << std::endl;
+    std::cerr << "  -p, --prefix PREFIX   对象名前缀（默认无）" << std::endl;
+    std::cerr << "      --threshold MB    不小于该大小的文件使用Multipart Upload（默认16）" << std::endl;
+    std::cerr << "      --part-jobs N     单个大文件同时上传的分块数（默认4）" << std::endl;
+    std::cerr << "      --retries N       单个请求最多尝试次数（默认5）" << std::endl;
+    std::cerr << "      --limit-rate MB       整个批次的带宽上限，单位MB/s，可带小数（默认不限）" << std::endl;
+    std::cerr << "      --object-rate MB      单个对象的带宽上限，单位MB/s（默认不限）" << std::endl;
+    std::cerr << "      --priority CLASS      流量优先级: interactive、bulk（默认）或background" << std::endl;
+    std::cerr << "      --huge-pages      分块缓冲区使用2MB大页（未预留时退回透明大页）" << std::endl;
+    std::cerr << "      --progress MODE   进度输出到stderr: tty、json或none（默认终端时tty，否则none）" << std::endl;
+}
+
+// 只有长选项的命令行参数编号，避开单字符选项的取值范围
+enum LongOnlyOption {
+    OPT_THRESHOLD = 256,
+    OPT_PART_JOBS,
+    OPT_RETRIES,
+    OPT_PROGRESS,
+    OPT_LIMIT_RATE,
+    OPT_OBJECT_RATE,
+    OPT_PRIORITY,
+    OPT_HUGE_PAGES,
+};
+
+int main(int argc, char* argv[]) {
+    // ==================== 命令行参数解析 ====================
+    BulkUploader::Options options;
+    std::string bucketName = "video";  // 目标存储桶名称
+    std::string prefix;                // 对象名前缀
+    ProgressMode progressMode = ProgressReporter::DefaultMode();
+    static const option longOptions[] = {
+        {"jobs", required_argument, nullptr, 'j'},
+        {"bucket", required_argument, nullptr, 'b'},
+        {"prefix", required_argument, nullptr, 'p'},
+        {"threshold", required_argument, nullptr, OPT_THRESHOLD},
+        {"part-jobs", required_argument, nullptr, OPT_PART_JOBS},
+        {"retries", required_argument, nullptr, OPT_RETRIES},
+        {"progress", required_argument, nullptr, OPT_PROGRESS},
+        {"limit-rate", required_argument, nullptr, OPT_LIMIT_RATE},
+        {"object-rate", required_argument, nullptr, OPT_OBJECT_RATE},
+        {"priority", required_argument, nullptr, OPT_PRIORITY},
+        {"huge-pages", no_argument, nullptr, OPT_HUGE_PAGES},
+        {nullptr, 0, nullptr, 0},
+    };
+    int opt;
+    while ((opt = getopt_long(argc, argv, "j:b:p:", longOptions, nullptr)) != -1) {
+        switch (opt) {
+        case 'j':
+            options.workers = std::strtoul(optarg, nullptr, 10);
+            break;
+        case 'b':
+            bucketName = optarg;
+            break;
+        case 'p':
+            prefix = optarg;
+            break;
+        case OPT_THRESHOLD:
+            // S3分块最小5MB，小于此值的阈值没有意义
+            options.multipartThreshold =
+                std::max<size_t>(std::strtoul(optarg, nullptr, 10) * PartPlanner::MB, PartPlanner::MIN_PART_SIZE);
+            break;
+        case OPT_PART_JOBS:
+            options.partConcurrency = std::strtoul(optarg, nullptr, 10);
+            break;
+        case OPT_RETRIES:
+            options.retryPolicy.maxAttempts = std::strtoul(optarg, nullptr, 10);
+            break;
+        case OPT_PROGRESS:
+            if (!ProgressReporter::ParseMode(optarg, progressMode)) {
+                PrintUsage(argv[0]);
+                return 1;
+            }
+            break;
+        case OPT_LIMIT_RATE:
+            if (!BandwidthGovernor::ParseRate(optarg, options.totalRate)) {
+                PrintUsage(argv[0]);
+                return 1;
+            }
+            break;
+        case OPT_OBJECT_RATE:
+            if (!BandwidthGovernor::ParseRate(optarg, options.objectRate)) {
+                PrintUsage(argv[0]);
+                return 1;
+            }
+            break;
+        case OPT_PRIORITY:
+            if (!BandwidthGovernor::ParseClass(optarg, options.trafficClass)) {
+                PrintUsage(argv[0]);
+                return 1;
+            }
+            break;
+        case OPT_HUGE_PAGES:
+            BufferPool::Instance().SetHugePages(true);
+            break;
+        default:
+            PrintUsage(argv[0]);
+            return 1;
+        }
+    }
+    if (optind != argc - 1 || options.workers == 0 || options.partConcurrency == 0) {
+        PrintUsage(argv[0]);
+        return 1;
+    }
+    std::filesystem::path rootDir = argv[optind];
+
+    std::error_code ec;
+    if (!std::filesystem::is_directory(rootDir, ec)) {
+        std::cerr << "不是目录: " << rootDir.string() << std::endl;
+        return 1;
+    }
+
+    // MinIO服务器连接配置，根据实际环境修改（见minio_connection.h中的默认值）
+    MinioConfig config;
+
+    std::cout << "=== 开始批量上传 ===" << std::endl;
+    std::cout << "源目录: " << rootDir.string() << std::endl;
+    std::cout << "目标位置: " << bucketName << "/" << prefix << std::endl;
+    std::cout << "并发对象数: " << options.workers << "，Multipart阈值: "
+              << options.multipartThreshold / PartPlanner::MB << "MB" << std::endl;
+
+    // 进度报告先于上传器声明：上传器析构时等待的在途文件仍会更新进度
+    ProgressReporter progress(progressMode, 0);
+    BulkUploader bulk(config, bucketName, options);
+    bulk.SetProgress(&progress);
+    progress.Start();
+
+    // ==================== 遍历目录并提交 ====================
+    // 边遍历边提交，队列满时Submit阻塞，内存中只保留有限个待上传文件
+    size_t filesQueued = 0;
+    auto it = std::filesystem::recursive_directory_iterator(
+        rootDir, std::filesystem::directory_options::skip_permission_denied, ec);
+    for (; !ec && it != std::filesystem::recursive_directory_iterator(); it.increment(ec)) {
+        std::error_code entryError;
+        if (!it->is_regular_file(entryError)) {
+            continue;  // 目录、符号链接到目录、设备文件等不上传
+        }
+        size_t size = it->file_size(entryError);
+        if (entryError) {
+            std::cerr << "跳过无法访问的文件 " << it->path().string() << ": " << entryError.message()
+                      << std::endl;
+            continue;
+        }
+        // 对象名使用正斜杠分隔的相对路径
+        std::string objectName = prefix + it->path().lexically_relative(rootDir).generic_string();
+        bulk.Submit(it->path().string(), objectName, size);
+        filesQueued++;
+    }
+    if (ec) {
+        std::cerr << "遍历目录出错: " << ec.message() << std::endl;
+    }
+
+    bulk.Wait();
+    progress.Stop();
+
+    // ==================== 汇总结果 ====================
+    BulkUploader::Stats stats = bulk.GetStats();
+    std::cout << "\n=== 批量上传完成 ===" << std::endl;
+    std::cout << "文件数: " << filesQueued << "，成功: " << stats.objectsUploaded
+              << "（其中Multipart: " << stats.multipartObjects << "），失败: " << stats.objectsFailed
+              << std::endl;
+    std::cout << "总字节数: " << stats.bytesUploaded << "，耗时: " << stats.elapsedSeconds << " 秒"
+              << std::endl;
+    std::cout << "吞吐量: " << stats.ObjectsPerSecond() << " 对象/秒，" << stats.MegabytesPerSecond()
+              << " MB/s" << std::endl;
+    BufferPool::Stats poolStats = BufferPool::Instance().GetStats();
+    std::cout << "缓冲区池: 借出 " << poolStats.acquires << " 次，复用命中率 "
+              << poolStats.HitRate() * 100 << "%，借出峰值 "
+              << poolStats.peakBytesInUse / PartPlanner::MB << "MB，池占用 "
+              << poolStats.bytesReserved / PartPlanner::MB << "MB" << std::endl;
+
+    std::vector<std::string> failures = bulk.Failures();
+    if (!failures.empty()) {
+        std::cerr << "\n失败的文件:" << std::endl;
+        for (const std::string& failure : failures) {
+            std::cerr << "  " << failure << std::endl;
+        }
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,38 @@
+#pragma once
+
+#include <string>
+#include <miniocpp/client.h>  // MinIO C++ SDK主要头文件
+
+/**
+ * MinIO连接配置与连接对象
+ *
+ * minio::s3::Client内部会缓存bucket所在的region等状态，并不保证多线程共享安全，
+ * 因此并发上传时每个工作线程各自持有一个MinioConnection。
+ */
+struct MinioConfig {
+    std::string endpoint = "localhost:9000";  // MinIO服务器地址和端口
+    std::string accessKey = "minioadmin";     // 访问密钥ID
+    std::string secretKey = "minioadmin";     // 秘密访问密钥
+    bool useSSL = false;                      // 是否使用SSL/TLS加密连接
+};
+
+class MinioConnection {
+public:
+    explicit MinioConnection(const MinioConfig& config)
+        : baseUrl_(config.endpoint, config.useSSL),
+          provider_(config.accessKey, config.secretKey),
+          client_(baseUrl_, &provider_) {}
+
+    MinioConnection(const MinioConnection&) = delete;
+    MinioConnection& operator=(const MinioConnection&) = delete;
+
+    minio::s3::Client& Client() { return client_; }
+    // SDK未封装的S3接口需要用BaseUrl自行构造minio::s3::Request
+    minio::s3::BaseUrl& Url() { return baseUrl_; }
+
+private:
+    // 声明顺序即初始化顺序：client_依赖baseUrl_和provider_
+    minio::s3::BaseUrl baseUrl_;
+    minio::creds::StaticProvider provider_;
+    minio::s3::Client client_;
+};
@@ -0,0 +1,290 @@
+#include <iostream>      // 标准输入输出流，用于控制台打印
+#include <cstdlib>       // std::strtoul/strtoull，解析命令行数值参数
+#include <getopt.h>      // getopt_long，解析命令行选项
+#include <memory>
+
+#include "bandwidth_governor.h"  // 令牌桶带宽控制
+#include "minio_connection.h"    // MinIO连接配置
+#include "object_cache.h"        // 本地对象缓存
+#include "part_planner.h"        // MB等分块常量
+#include "progress_reporter.h"   // 异步进度报告
+#include "range_downloader.h"    // 并发分段下载器
+
+/**
+ * MinIO 并发分段下载程序
+ *
+ * 功能说明：
+ * 1. 先HEAD对象取得大小和ETag，按--range-size把对象切成字节范围；--compress或--encrypt-key
+ *    上传的对象（带content-codec/client-encryption元数据）不做解压解密，直接报错，
+ *    需用minio_basic下载
+ * 2. -j 个范围同时以带Range的GetObject下载，每个工作线程一个MinIO客户端，
+ *    吞吐量随连接数增长，直到网卡或服务端成为瓶颈
+ * 3. 输出文件先按对象大小fallocate一次分配空间（避免边写边增长造成extent碎片），
+ *    每段数据写到所在偏移，没有顺序重排
+ * 4. 各范围请求带If-Match，下载期间对象被覆盖时失败而不是拼出混杂的文件
+ * 5. 范围失败时从已写入的位置续传该范围（--retries），失败时删除不完整的输出文件
+ * 6. --limit-rate/--priority 与上传程序共用令牌桶带宽控制
+ * 7. --resume 把ETag和已落盘的范围记入<输出文件>.download-journal，中断后重新运行只请求
+ *    缺失的范围（If-Match上次的ETag）；对象已被覆盖时丢弃旧文件从头下载
+ * 8. 接收数据先合并进1MB的写缓冲区，由后台线程落盘（--writer pwrite或uring），
+ *    SDK回调不等待磁盘；结束时报告接收线程因缓冲区全部待写而等待的次数和时长
+ * 9. --direct 以O_DIRECT写入，绕过页缓存：批量恢复大量数据时不会挤掉其他进程的缓存，
+ *    文件系统不支持时退回普通写入
+ * 10. --cache DIR 启用本地对象缓存：以存储桶+对象名为键、按ETag区分版本，超过--cache-fresh
+ *     后带If-None-Match验证（304时不传输数据），命中时用copy_file_range拷出；多个进程同时
+ *     请求同一对象时只有一个下载，缓存总大小按LRU限制在--cache-size以内
+ *
+ * 依赖库：
+ * - MinIO C++ SDK - 对象存储操作
+ */
+
+static void PrintUsage(const char* program) {
+    std::cerr << "使用方法: " << program << " [选项] <object>" << std::endl;
+    std::cerr << "  -b, --bucket NAME      存储桶（默认video）" << std::endl;
+    std::cerr << "  -o, --output FILE      输出文件（默认 downloaded-对象名最后一段）" << std::endl;
+    std::cerr << "  -j, --jobs N           同时下载的范围数（默认8）" << std::endl;
+    std::cerr << "      --range-size MB    每个范围的大小（默认16）" << std::endl;
+    std::cerr << "      --retries N        单个请求最多尝试次数（默认5）" << std::endl;
+    std::cerr << "      --resume           记录续传日志，重新运行时只下载缺失的范围" << std::endl;
+    std::cerr << "      --direct           以O_DIRECT写入，绕过页缓存（适合批量恢复）" << std::endl;
+    std::cerr << "      --writer BACKEND   写文件后端: pwrite（默认）或uring（需编译时找到liburing）" << std::endl;
+    std::cerr << "      --cache DIR        本地对象缓存目录，命中时不重新下载" << std::endl;
+    std::cerr << "      --cache-size MB    缓存总大小上限（默认10240）" << std::endl;
+    std::cerr << "      --cache-fresh SEC  缓存条目确认后多少秒内不再向服务端验证（默认0，每次验证）" << std::endl;
+    std::cerr << "      --limit-rate MB    下载带宽上限，单位MB/s，可带小数（默认不限）" << std::endl;
+    std::cerr << "      --priority CLASS   流量优先级: interactive（默认）、bulk或background" << std::endl;
+    std::cerr << "      --progress MODE    进度输出到stderr: tty、json或none（默认终端时tty，否则none）" << std::endl;
+}
+
+// 只有长选项的命令行参数编号，避开单字符选项的取值范围
+enum LongOnlyOption {
+    OPT_RANGE_SIZE = 256,
+    OPT_RETRIES,
+    OPT_LIMIT_RATE,
+    OPT_PRIORITY,
+    OPT_PROGRESS,
+    OPT_RESUME,
+    OPT_WRITER,
+    OPT_DIRECT,
+    OPT_CACHE,
+    OPT_CACHE_SIZE,
+    OPT_CACHE_FRESH,
+};
+
+int main(int argc, char* argv[]) {
+    // ==================== 命令行参数解析 ====================
+    std::string bucketName = "video";  // 存储桶名称
+    std::string outputPath;            // 输出文件路径
+    size_t concurrency = 8;            // 同时下载的范围数
+    size_t rangeSize = RangeDownloader::DEFAULT_RANGE_SIZE;  // 每个范围的大小
+    RetryPolicy retryPolicy;           // 单个请求的重试策略
+    uint64_t limitRate = 0;            // 下载带宽上限（字节/秒），0表示不限
+    TrafficClass trafficClass = TrafficClass::kInteractive;  // 下载通常有人在等待结果
+    ProgressMode progressMode = ProgressReporter::DefaultMode();
+    bool resumeMode = false;           // 是否启用断点续传
+    WriterBackend writerBackend = WriterBackend::kPwrite;  // 输出文件写入后端
+    bool directIo = false;             // 是否以O_DIRECT写入
+    std::string cacheDir;              // 本地对象缓存目录，空表示不使用缓存
+    uint64_t cacheSize = ObjectCache::DEFAULT_MAX_BYTES;  // 缓存总大小上限
+    unsigned int cacheFresh = 0;       // 缓存条目的免验证时间（秒）
+    static const option longOptions[] = {
+        {"bucket", required_argument, nullptr, 'b'},
+        {"output", required_argument, nullptr, 'o'},
+        {"jobs", required_argument, nullptr, 'j'},
+        {"range-size", required_argument, nullptr, OPT_RANGE_SIZE},
+        {"retries", required_argument, nullptr, OPT_RETRIES},
+        {"limit-rate", required_argument, nullptr, OPT_LIMIT_RATE},
+        {"priority", required_argument, nullptr, OPT_PRIORITY},
+        {"progress", required_argument, nullptr, OPT_PROGRESS},
+        {"resume", no_argument, nullptr, OPT_RESUME},
+        {"writer", required_argument, nullptr, OPT_WRITER},
+        {"direct", no_argument, nullptr, OPT_DIRECT},
+        {"cache", required_argument, nullptr, OPT_CACHE},
+        {"cache-size", required_argument, nullptr, OPT_CACHE_SIZE},
+        {"cache-fresh", required_argument, nullptr, OPT_CACHE_FRESH},
+        {nullptr, 0, nullptr, 0},
+    };
+    int opt;
+    while ((opt = getopt_long(argc, argv, "b:o:j:", longOptions, nullptr)) != -1) {
+        switch (opt) {
+        case 'b':
+            bucketName = optarg;
+            break;
+        case 'o':
+            outputPath = optarg;
+            break;
+        case 'j':
+            concurrency = std::strtoul(optarg, nullptr, 10);
+            break;
+        case OPT_RANGE_SIZE:
+            rangeSize = std::strtoul(optarg, nullptr, 10) * PartPlanner::MB;
+            break;
+        case OPT_RETRIES:
+            retryPolicy.maxAttempts = std::strtoul(optarg, nullptr, 10);
+            break;
+        case OPT_LIMIT_RATE:
+            if (!BandwidthGovernor::ParseRate(optarg, limitRate)) {
+                PrintUsage(argv[0]);
+                return 1;
+            }
+            break;
+        case OPT_PRIORITY:
+            if (!BandwidthGovernor::ParseClass(optarg, trafficClass)) {
+                PrintUsage(argv[0]);
+                return 1;
+            }
+            break;
+        case OPT_PROGRESS:
+            if (!ProgressReporter::ParseMode(optarg, progressMode)) {
+                PrintUsage(argv[0]);
+                return 1;
+            }
+            break;
+        case OPT_RESUME:
+            resumeMode = true;
+            break;
+        case OPT_WRITER:
+            if (std::string(optarg) == "pwrite") {
+                writerBackend = WriterBackend::kPwrite;
+            } else if (std::string(optarg) == "uring") {
+                writerBackend = WriterBackend::kUring;
+            } else {
+                PrintUsage(argv[0]);
+                return 1;
+            }
+            break;
+        case OPT_DIRECT:
+            directIo = true;
+            break;
+        case OPT_CACHE:
+            cacheDir = optarg;
+            break;
+        case OPT_CACHE_SIZE:
+            cacheSize = std::strtoull(optarg, nullptr, 10) * PartPlanner::MB;
+            break;
+        case OPT_CACHE_FRESH:
+            cacheFresh = static_cast<unsigned int>(std::strtoul(optarg, nullptr, 10));
+            break;
+        default:
+            PrintUsage(argv[0]);
+            return 1;
+        }
+    }
+    if (optind != argc - 1 || concurrency == 0 || rangeSize == 0) {
+        PrintUsage(argv[0]);
+        return 1;
+    }
+    std::string objectName = argv[optind];
+    if (outputPath.empty()) {
+        outputPath = "downloaded-" + objectName.substr(objectName.find_last_of('/') + 1);
+    }
+
+    // MinIO服务器连接配置，根据实际环境修改（见minio_connection.h中的默认值）
+    MinioConfig config;
+
+    // 带宽控制：未限速时不计量，数据路径上没有额外开销
+    BandwidthGovernor governor(limitRate);
+    std::unique_ptr<BandwidthGovernor::Transfer> bandwidth;
+    if (limitRate > 0) {
+        bandwidth = governor.NewTransfer(trafficClass);
+    }
+
+    // ==================== 查询对象并分段下载 ====================
+    // 下载到path并返回ETag和大小；启用缓存时作为未命中时的下载函数
+    auto download = [&](const std::string& path, std::string& etag, uint64_t& size,
+                        std::string& error) -> bool {
+        RangeDownloader downloader(config, bucketName, objectName, concurrency, rangeSize);
+        downloader.SetRetryPolicy(retryPolicy, RangeDownloader::DEFAULT_RETRY_BUDGET);
+        downloader.SetBandwidth(bandwidth.get());
+        downloader.SetWriter(writerBackend);
+        downloader.SetDirectIo(directIo);
+        if (!downloader.Stat() || (resumeMode && !downloader.LoadJournal(path))) {
+            error = downloader.LastError();
+            return false;
+        }
+
+        std::cout << "=== 开始分段下载 ===" << std::endl;
+        std::cout << "对象: " << bucketName << "/" << objectName << "，大小: "
+                  << downloader.ObjectSize() << " 字节，ETag: " << downloader.Etag() << std::endl;
+        std::cout << "输出文件: " << path << std::endl;
+        std::cout << "范围大小: " << downloader.RangeSize() / PartPlanner::MB << "MB，范围数: "
+                  << downloader.RangeCount() << "，并发数: " << concurrency << std::endl;
+        if (downloader.Resumed()) {
+            std::cout << "续传: 已完成 " << downloader.CompletedRangeCount() << " 个范围" << std::endl;
+        }
+
+        // 下载结束后先停止进度报告，最终进度输出在汇总信息之前
+        ProgressReporter progress(progressMode, downloader.ObjectSize());
+        progress.SetLabel("已下载");
+        downloader.SetProgress(&progress);
+        progress.Start();
+        bool ok = downloader.Download(path);
+        progress.Stop();
+        if (!ok) {
+            error = downloader.LastError();
+            return false;
+        }
+        etag = downloader.Etag();
+        size = downloader.ObjectSize();
+
+        RangeDownloader::Stats stats = downloader.GetStats();
+        std::cout << "\n=== 下载完成 ===" << std::endl;
+        std::cout << "总字节数: " << stats.bytesDownloaded << "，范围数: " << stats.rangesDownloaded
+                  << std::endl;
+        std::cout << "下载耗时: " << stats.elapsedSeconds << " 秒，吞吐量: "
+                  << stats.MegabytesPerSecond() << " MB/s" << std::endl;
+        if (stats.rangesSkipped > 0) {
+            std::cout << "续传跳过: " << stats.rangesSkipped << " 个范围，" << stats.bytesSkipped
+                      << " 字节" << std::endl;
+        }
+        if (stats.retries > 0) {
+            std::cout << "请求重试次数: " << stats.retries << std::endl;
+        }
+        if (stats.writeStalls > 0) {
+            std::cout << "写缓冲区已满等待: " << stats.writeStalls << " 次，共 "
+                      << stats.writeStallSeconds << " 秒（磁盘写入跟不上下载）" << std::endl;
+        }
+        return true;
+    };
+
+    std::string error;
+    std::string etag;
+    uint64_t size = 0;
+    bool ok;
+    if (cacheDir.empty()) {
+        ok = download(outputPath, etag, size, error);
+    } else {
+        // 缓存命中时不访问服务端或只做一次304验证，未命中时下载进缓存再拷到输出文件
+        MinioConnection connection(config);
+        ObjectCache cache(connection, cacheDir, cacheSize);
+        cache.SetFreshSeconds(cacheFresh);
+        ObjectCache::Result result;
+        ok = cache.Open(error) &&
+             cache.Get(bucketName, objectName, outputPath, download, result, error);
+        if (ok) {
+            static const char* SOURCE_NAMES[] = {"命中（未过期，未访问服务端）",
+                                                 "命中（服务端确认未变化）", "未命中，已下载"};
+            std::cout << "缓存: " << SOURCE_NAMES[static_cast<int>(result.source)];
+            if (result.coalesced) {
+                std::cout << "，等待了同时请求该对象的其他下载";
+            }
+            std::cout << std::endl;
+            if (!result.cached) {
+                std::cout << "对象大于缓存上限，未放入缓存" << std::endl;
+            }
+            if (result.evicted > 0) {
+                std::cout << "缓存淘汰: " << result.evicted << " 个条目" << std::endl;
+            }
+            std::cout << "输出文件: " << outputPath << "，大小: " << result.size << " 字节"
+                      << std::endl;
+        }
+    }
+    if (!ok) {
+        std::cerr << "下载失败: " << error << std::endl;
+        if (resumeMode) {
+            std::cerr << "已下载的范围已保留，使用 --resume 重新运行可继续下载" << std::endl;
+        }
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,178 @@
+#include <iostream>      // 标准输入输出流，用于控制台打印
+#include <atomic>        // 并发统计计数
+#include <chrono>        // 计时
+#include <cstdlib>       // std::strtoul、std::strtod，解析命令行数值参数
+#include <ctime>         // 当前时间，判断上传是否过期
+#include <getopt.h>      // getopt_long，解析命令行选项
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#include "minio_connection.h"   // MinIO连接配置
+#include "retry_policy.h"       // 指数退避重试
+#include "s3_multipart_api.h"   // ListMultipartUploads
+#include "thread_pool.h"        // 有界工作线程池
+
+/**
+ * MinIO 未完成Multipart Upload清理程序
+ *
+ * 功能说明：
+ * 1. 分页列出存储桶中（可按前缀过滤）所有未Complete也未Abort的Multipart Upload
+ * 2. 创建时间早于--older-than的上传视为遗留：上传进程崩溃或被杀死后，
+ *    已上传的分块会一直占用存储并拖慢列举，需要主动中止
+ * 3. AbortMultipartUpload在线程池上并发发出（-j），每个工作线程持有独立的MinIO客户端；
+ *    列举下一页与中止上一页同时进行，数万个遗留上传可在数秒内清理完
+ * 4. 中止请求按RetryPolicy重试；上传已不存在（NoSuchUpload）视为已清理
+ * 5. -n 只列出将被中止的上传，不实际中止
+ *
+ * 注意：阈值应大于最长的正常上传耗时，否则会中止仍在进行的上传；
+ * --resume 续传的上传在阈值内没有重启也会被清理。
+ *
+ * 依赖库：
+ * - MinIO C++ SDK - 对象存储操作
+ */
+
+static void PrintUsage(const char* program) {
+    std::cerr << "使用方法: " << program << " [选项]" << std::endl;
+    std::cerr << "  -b, --bucket NAME       存储桶（默认video）" << std::endl;
+    std::cerr << "  -p, --prefix PREFIX     只处理对象名以PREFIX开头的上传（默认全部）" << std::endl;
+    std::cerr << "      --older-than HOURS  中止创建时间早于HOURS小时前的上传，可带小数（默认24）" << std::endl;
+    std::cerr << "  -j, --jobs N            同时发出的中止请求数（默认64）" << std::endl;
+    std::cerr << "  -n, --dry-run           只列出将被中止的上传，不实际中止" << std::endl;
+    std::cerr << "      --retries N         单个请求最多尝试次数（默认5）" << std::endl;
+}
+
+// 只有长选项的命令行参数编号，避开单字符选项的取值范围
+enum LongOnlyOption {
+    OPT_OLDER_THAN = 256,
+    OPT_RETRIES,
+};
+
+int main(int argc, char* argv[]) {
+    // ==================== 命令行参数解析 ====================
+    std::string bucketName = "video";  // 存储桶名称
+    std::string prefix;                // 对象名前缀
+    double olderThanHours = 24;        // 过期阈值
+    size_t workers = 64;               // 并发中止请求数
+    bool dryRun = false;               // 只列出不中止
+    RetryPolicy retryPolicy;           // 单个请求的重试策略
+    static const option longOptions[] = {
+        {"bucket", required_argument, nullptr, 'b'},
+        {"prefix", required_argument, nullptr, 'p'},
+        {"older-than", required_argument, nullptr, OPT_OLDER_THAN},
+        {"jobs", required_argument, nullptr, 'j'},
+        {"dry-run", no_argument, nullptr, 'n'},
+        {"retries", required_argument, nullptr, OPT_RETRIES},
+        {nullptr, 0, nullptr, 0},
+    };
+    int opt;
+    while ((opt = getopt_long(argc, argv, "b:p:j:n", longOptions, nullptr)) != -1) {
+        switch (opt) {
+        case 'b':
+            bucketName = optarg;
+            break;
+        case 'p':
+            prefix = optarg;
+            break;
+        case OPT_OLDER_THAN:
+            olderThanHours = std::strtod(optarg, nullptr);
+            break;
+        case 'j':
+            workers = std::strtoul(optarg, nullptr, 10);
+            break;
+        case 'n':
+            dryRun = true;
+            break;
+        case OPT_RETRIES:
+            retryPolicy.maxAttempts = std::strtoul(optarg, nullptr, 10);
+            break;
+        default:
+            PrintUsage(argv[0]);
+            return 1;
+        }
+    }
+    if (optind != argc || workers == 0 || olderThanHours < 0) {
+        PrintUsage(argv[0]);
+        return 1;
+    }
+
+    // MinIO服务器连接配置，根据实际环境修改（见minio_connection.h中的默认值）
+    MinioConfig config;
+    MinioConnection listConnection(config);  // 主线程列举使用
+
+    std::time_t cutoff = std::time(nullptr) - static_cast<std::time_t>(olderThanHours * 3600);
+    std::cout << "=== 清理未完成的Multipart Upload ===" << std::endl;
+    std::cout << "位置: " << bucketName << "/" << prefix << "，阈值: " << olderThanHours << " 小时"
+              << (dryRun ? "（只列出）" : "") << std::endl;
+
+    // 连接先于线程池声明：线程池析构时工作线程退出，之后才销毁连接
+    std::vector<std::unique_ptr<MinioConnection>> connections;
+    for (size_t i = 0; i < workers; ++i) {
+        connections.push_back(std::make_unique<MinioConnection>(config));
+    }
+    RetryBudget retryBudget(workers * 10);
+    std::atomic<size_t> aborted{0};
+    std::atomic<size_t> failed{0};
+    std::mutex outputMutex;
+    // 排队容量取线程数的几倍：列举下一页时工作线程仍有任务可做
+    ThreadPool pool(workers, workers * 4);
+
+    // ==================== 列举并提交中止 ====================
+    auto startTime = std::chrono::steady_clock::now();
+    size_t listed = 0;
+    size_t expired = 0;
+    std::string error;
+    bool ok = ListMultipartUploads(listConnection, bucketName, prefix,
+                                   [&](const std::vector<MultipartUploadInfo>& uploads) {
+        for (const MultipartUploadInfo& upload : uploads) {
+            listed++;
+            // 创建时间无法解析时保守处理，不中止
+            if (upload.initiated == 0 || upload.initiated > cutoff) {
+                continue;
+            }
+            expired++;
+            if (dryRun) {
+                std::cout << upload.object << "  " << upload.uploadId << std::endl;
+                continue;
+            }
+            pool.Submit([&, upload](size_t workerIndex) {
+                minio::s3::AbortMultipartUploadArgs abortArgs;
+                abortArgs.bucket = bucketName;
+                abortArgs.object = upload.object;
+                abortArgs.upload_id = upload.uploadId;
+
+                minio::s3::AbortMultipartUploadResponse abortResp;
+                std::string abortError;
+                bool done = RetryCall(retryPolicy, retryBudget, upload.object, [&] {
+                    return connections[workerIndex]->Client().AbortMultipartUpload(abortArgs);
+                }, abortResp, abortError);
+                // 其他进程已中止或刚好完成，结果同样是不再占用存储
+                if (done || abortResp.code == "NoSuchUpload") {
+                    aborted++;
+                    return;
+                }
+                failed++;
+                std::lock_guard<std::mutex> lock(outputMutex);
+                std::cerr << "中止失败 " << upload.object << " (" << upload.uploadId
+                          << "): " << abortError << std::endl;
+            });
+        }
+        return true;
+    }, error);
+    pool.Wait();
+    double seconds =
+        std::chrono::duration<double>(std::chrono::steady_clock::now() - startTime).count();
+
+    // ==================== 汇总结果 ====================
+    std::cout << "\n=== 清理完成 ===" << std::endl;
+    std::cout << "未完成上传: " << listed << "，过期: " << expired;
+    if (!dryRun) {
+        std::cout << "，已中止: " << aborted << "，失败: " << failed;
+    }
+    std::cout << "，耗时: " << seconds << " 秒" << std::endl;
+    if (!ok) {
+        std::cerr << error << std::endl;
+        return 1;
+    }
+    return failed > 0 ? 1 : 0;
+}
@@ -1,22 +1,74 @@
 #include <iostream>    // 标准输入输出流，用于控制台打印
 #include <fstream>     // 文件流操作，用于读取本地文件
-#include <vector>      // 动态数组容器，用作数据缓冲区
-#include <sstream>     // 字符串流，用于内存数据转换为流
-#include <list>        // 链表容器，用于存储Multipart Upload的分块信息
+#include <cstdlib>     // std::strtoul，解析命令行数值参数
+#include <chrono>      // 计时
+#include <map>         // 对象的用户元数据
+#include <set>         // 续传时已确认的分块编号
+#include <thread>      // std::thread::hardware_concurrency，默认压缩线程数
+#include <getopt.h>    // getopt_long，解析命令行选项
+#include <sys/stat.h>  // stat，获取源文件修改时间
 #include <miniocpp/client.h>  // MinIO C++ SDK主要头文件
 
+#include "bandwidth_governor.h"  // 令牌桶带宽控制
+#include "buffer_pool.h"         // 进程级缓冲区池
+#include "content_hasher.h"      // 流式内容摘要
+#include "dedup_index.h"         // 秒传去重索引
+#include "direct_put.h"          // 不拷贝数据的单次PutObject
+#include "file_reader.h"         // 可插拔文件读取后端
+#include "mapped_file.h"         // 只读内存映射文件
+#include "minio_connection.h"    // MinIO连接配置
+#include "multipart_uploader.h"  // 并发Multipart Upload上传器
+#include "part_buffer.h"         // 预分配数据缓冲区
+#include "part_compressor.h"     // 并行zstd压缩
+#include "part_encryptor.h"      // 客户端AES-256-GCM加密
+#include "part_hasher.h"         // 与上传并行的分块摘要
+#include "part_planner.h"        // 分块大小规划器
+#include "part_reader.h"         // 分块读取线程
+#include "progress_reporter.h"   // 异步进度报告
+#include "s3_multipart_api.h"    // ListParts等SDK未封装的接口
+#include "stream_source.h"       // 长度未知的输入流
+#include "upload_journal.h"      // 断点续传日志
+
 /**
  * MinIO 流模式上传示例程序
  * 
  * 功能说明：
- * 1. 从文件每次读取32KB数据到内存 - 模拟Web客户端分块上传行为
+ * 1. 从文件按分块读取数据到内存 - 读取后端可选pread/io_uring，可选O_DIRECT
  * 2. 从内存中读取数据上传到MinIO - 模拟服务端接收并转发数据
  * 3. 使用Multipart Upload API将分块组合成完整文件 - 确保最终存储完整性
  * 4. 模拟边读取文件数据边上传的场景 - 流式处理，减少内存占用
+ * 5. 大文件分块由MultipartUploader在线程池上并发上传（-j 指定并发数）
+ * 6. 独立读取线程提前填充后续分块（-r 指定预读深度），读盘与网络发送流水线重叠
+ * 7. -m 以mmap映射源文件，分块和小文件都直接引用映射区，省去读取拷贝
+ * 8. --reader uring 以io_uring发起队列深度为N的大块读请求，直接读入分块缓冲区
+ * 9. 分块大小由PartPlanner根据文件大小、并发数和内存预算规划，可选运行期自适应
+ * 10. --resume 把upload_id和已完成分块记入续传日志，进程重启后与ListParts核对，只补传缺失分块
+ * 11. 分块遇到瞬时错误时按指数退避+抖动单独重传（--retries/--retry-budget），
+ *     重试耗尽后自动中止Multipart Upload（续传模式下保留，供下次续传）
+ * 12. 源文件为"-"或指定--fd时从长度未知的流读取（如 ffmpeg ... | minio_stream -o obj -），
+ *     先缓冲第一个分块再决定PutObject还是Multipart Upload，以EOF判断最后一个分块
+ * 13. 进度由独立线程按固定间隔报告（--progress tty|json|none），数据路径只更新原子计数器
+ * 14. --dedup 秒传：上传前流式计算SHA-256并查询存储桶内的去重索引，
+ *     内容已存在时在服务端CopyObject，不再上传数据；上传的对象带content-sha256元数据，
+ *     命中时核对该元数据，索引指向已被覆盖的对象时不会误判为相同内容
+ * 15. --hash 在上传的同时由哈希线程计算每个分块的MD5和整个对象的SHA-256（每字节各一次，
+ *     MD5分给多个线程），与UploadPart读取同一块缓冲区，哈希耗时隐藏在网络发送时间之后
+ * 16. --verify 每个请求带Content-MD5由服务端校验，并在本地核对分块ETag和
+ *     Multipart整体ETag（所有分块MD5拼接后的MD5-分块数）
+ * 17. --limit-rate 以令牌桶限制上传带宽，按SDK发送进度细粒度计量，5MB分块不会整块突发；
+ *     --priority 指定本进程流量的优先级
+ * 18. --compress 上传前在多个线程上并行zstd压缩（文件和流输入都适用），压缩块首尾相接
+ *     成一个zstd流，按流式上传的方式打包成不小于5MB的分块；对象带content-codec元数据，
+ *     minio_basic下载时据此流式解压
+ * 19. --encrypt-key 上传前以AES-256-GCM在客户端加密（OpenSSL自动使用AES-NI），按1MB记录
+ *     在压缩线程池规模的线程上并行加密，与--compress同时使用时先压缩后加密；
+ *     对象带client-encryption元数据，minio_basic持有同一密钥文件时流式解密
+ * 20. 分块缓冲区、压缩/加密块缓冲区都从进程级缓冲区池按固定规格借还，页对齐、可复用；
+ *     --huge-pages 以2MB大页分配，结束时输出池的复用命中率和借出峰值
  * 
  * 核心技术特点：
  * - 双路径处理：根据文件大小自动选择最优上传策略
- * - 内存友好：大文件处理时内存占用恒定（最大5MB+32KB）
+ * - 内存友好：大文件处理时内存占用恒定（不超过--memory指定的预算）
  * - 完整性保证：确保MinIO中存储的是完整文件而非分块文件
  * - Web场景模拟：真实模拟Web分块上传的服务端处理逻辑
  * 
@@ -25,38 +77,480 @@
  * 
  */
 
+static void PrintUsage(const char* program) {
+    std::cerr << "使用方法: " << program << " [选项] <source_file | ->" << std::endl;
+    std::cerr << "       " << program << " [选项] --fd N -o OBJECT" << std::endl;
+    std::cerr << "  -o, --object NAME    目标对象名（默认使用源文件名；从流读取时必须指定）" << std::endl;
+    std::cerr << "      --fd N           从已打开的文件描述符N读取长度未知的数据" << std::endl;
+    std::cerr << "      --dedup          上传前按内容摘要查重，已存在时服务端复制（秒传）" << std::endl;
+    std::cerr << "      --hash           上传的同时计算分块和整个对象的摘要" << std::endl;
+    std::cerr << "      --verify         发送Content-MD5并校验分块和整体ETag（服务端不能开启SSE-KMS/SSE-C）" << std::endl;
+    std::cerr << "      --compress[=N]   上传前以zstd压缩，N为压缩级别（默认3）" << std::endl;
+    std::cerr << "      --compress-threads N 压缩/加密线程数（默认CPU核数）" << std::endl;
+    std::cerr << "      --encrypt-key FILE 以FILE中的256位主密钥在客户端加密（32字节或64位十六进制）" << std::endl;
+    std::cerr << "      --limit-rate MB  上传带宽上限，单位MB/s，可带小数（默认不限）" << std::endl;
+    std::cerr << "      --priority CLASS 流量优先级: interactive、bulk（默认）或background" << std::endl;
+    std::cerr << "      --progress MODE  进度输出到stderr: tty、json或none（默认终端时tty，否则none）" << std::endl;
+    std::cerr << "  -j, --jobs N         大文件同时上传的分块数（默认4）" << std::endl;
+    std::cerr << "  -r, --read-ahead N   读取线程最多领先上传的分块数（默认2）" << std::endl;
+    std::cerr << "  -m, --mmap           以内存映射方式读取源文件，分块直接引用映射区" << std::endl;
+    std::cerr << "      --reader NAME    大文件读取后端: pread（默认）或 uring" << std::endl;
+    std::cerr << "      --queue-depth N  io_uring在途读请求数（默认8）" << std::endl;
+    std::cerr << "      --direct         以O_DIRECT读取，绕过页缓存" << std::endl;
+    std::cerr << "      --huge-pages     缓冲区使用2MB大页（未预留时退回透明大页）" << std::endl;
+    std::cerr << "      --part-size MB   固定分块大小（默认按文件大小和内存预算自动规划）" << std::endl;
+    std::cerr << "      --memory MB      暂存缓冲区内存预算（默认256）" << std::endl;
+    std::cerr << "      --adaptive       根据实测分块上传耗时动态调整分块大小" << std::endl;
+    std::cerr << "      --resume         记录续传日志，重启后只上传缺失的分块" << std::endl;
+    std::cerr << "      --retries N      单个请求最多尝试次数（默认5）" << std::endl;
+    std::cerr << "      --retry-budget N 整个上传允许的重试总次数（默认100）" << std::endl;
+}
+
+// 只有长选项的命令行参数编号，避开单字符选项的取值范围
+enum LongOnlyOption {
+    OPT_READER = 256,
+    OPT_QUEUE_DEPTH,
+    OPT_DIRECT,
+    OPT_PART_SIZE,
+    OPT_MEMORY,
+    OPT_ADAPTIVE,
+    OPT_RESUME,
+    OPT_RETRIES,
+    OPT_RETRY_BUDGET,
+    OPT_FD,
+    OPT_PROGRESS,
+    OPT_DEDUP,
+    OPT_HASH,
+    OPT_VERIFY,
+    OPT_LIMIT_RATE,
+    OPT_PRIORITY,
+    OPT_COMPRESS,
+    OPT_COMPRESS_THREADS,
+    OPT_ENCRYPT_KEY,
+    OPT_HUGE_PAGES,
+};
+
+// 为单次PutObject计算内容MD5并带上Content-MD5头，返回十六进制MD5用于核对ETag
+static std::string AddContentMd5(minio::s3::BaseArgs& args, std::string_view data) {
+    ContentHasher md5(DigestAlgorithm::kMd5);
+    md5.Update(data.data(), data.size());
+    std::string digest = md5.Final();
+    args.extra_headers.Add("Content-MD5", ContentHasher::ToBase64(digest));
+    return ContentHasher::ToHex(digest);
+}
+
+// 输出缓冲区池的使用情况：命中率低或峰值远超预算时说明缓冲区规格过多或没有及时归还
+static void PrintBufferPoolStats() {
+    BufferPool::Stats stats = BufferPool::Instance().GetStats();
+    std::cout << "缓冲区池: 借出 " << stats.acquires << " 次，复用命中率 " << stats.HitRate() * 100
+              << "%，借出峰值 " << stats.peakBytesInUse / PartPlanner::MB << "MB，池占用 "
+              << stats.bytesReserved / PartPlanner::MB << "MB";
+    if (stats.hugePageSlabs > 0) {
+        std::cout << "，大页内存块 " << stats.hugePageSlabs << " 个";
+    }
+    std::cout << std::endl;
+}
+
+/**
+ * 从长度未知的输入流上传
+ *
+ * 先把第一个分块读满：读到EOF说明整个流不超过一个分块，用一次PutObject上传；
+ * 否则创建Multipart Upload，之后每读满一个缓冲区就提交一个分块，读到EOF的那个
+ * 缓冲区就是最后一个分块（可以小于5MB，也可能为空而不提交）。
+ * 数据只在缓冲区中停留，不需要先落盘成临时文件。
+ * source输出的是压缩或加密后的数据时，userMetadata记录变换方式，写入对象的用户元数据。
+ */
+static int UploadFromStream(SequentialSource& source, MinioConnection& connection,
+                            const MinioConfig& config, const std::string& bucketName,
+                            const std::string& objectName, size_t concurrency, size_t readAhead,
+                            size_t partSize, const RetryPolicy& retryPolicy, size_t retryBudget,
+                            ProgressMode progressMode, bool verifyIntegrity,
+                            BandwidthGovernor::Transfer* bandwidth,
+                            const std::map<std::string, std::string>& userMetadata) {
+    std::cout << "=== 开始流式上传（长度未知）===" << std::endl;
+    std::cout << "输入: " << source.Name() << std::endl;
+    std::cout << "目标位置: " << bucketName << "/" << objectName << std::endl;
+    std::cout << "分块大小: " << partSize / PartPlanner::MB << "MB，可上传的最大对象: "
+              << partSize / PartPlanner::MB * PartPlanner::MAX_PART_COUNT / 1024 << "GB" << std::endl;
+
+    // 进度报告先于上传器声明：上传器析构时等待的在途分块仍会更新进度
+    ProgressReporter progress(progressMode, 0);
+    MultipartUploader uploader(config, bucketName, objectName, concurrency, partSize, readAhead);
+    uploader.SetRetryPolicy(retryPolicy, retryBudget);
+    uploader.SetVerifyIntegrity(verifyIntegrity);
+    uploader.SetBandwidth(bandwidth);
+    for (const auto& [key, value] : userMetadata) {
+        uploader.AddHeader("x-amz-meta-" + key, value);
+    }
+
+    // ==================== 缓冲第一个分块，决定上传方式 ====================
+    PartBuffer* partBuffer = uploader.AcquireBuffer();
+    size_t bytesRead = 0;
+    if (!source.ReadFull(partBuffer->Data(), partBuffer->Capacity(), bytesRead)) {
+        std::cerr << source.LastError() << std::endl;
+        uploader.ReleaseBuffer(partBuffer);
+        return 1;
+    }
+
+    if (source.Eof()) {
+        // 整个流装得下一个分块：一次PutObject，不产生Multipart Upload的额外请求
+        std::cout << "输入在第一个分块内结束，共 " << bytesRead << " 字节，使用普通PutObject上传..."
+                  << std::endl;
+        // 请求体直接引用缓冲区，不经过SDK的5MB分块缓冲区
+        minio::s3::PutObjectApiArgs args;
+        args.bucket = bucketName;
+        args.object = objectName;
+        args.data = std::string_view(partBuffer->Data(), bytesRead);
+        std::string md5Hex = verifyIntegrity ? AddContentMd5(args, args.data) : "";
+        if (bandwidth != nullptr) {
+            args.progressfunc = bandwidth->UploadMeter();
+        }
+        for (const auto& [key, value] : userMetadata) {
+            args.headers.Add("x-amz-meta-" + key, value);
+        }
+        minio::s3::PutObjectResponse resp = PutObjectDirect(connection.Client(), args);
+        uploader.ReleaseBuffer(partBuffer);
+        if (!resp) {
+            std::cerr << "流上传失败: " << resp.Error().String() << std::endl;
+            return 1;
+        }
+        if (verifyIntegrity && TrimEtag(resp.etag) != md5Hex) {
+            std::cerr << "ETag校验失败: 服务端 " << resp.etag << "，本地MD5 " << md5Hex << std::endl;
+            return 1;
+        }
+        std::cout << "\n=== 流上传完成 ===" << std::endl;
+        std::cout << "ETag: " << (resp.etag.empty() ? "无" : resp.etag) << std::endl;
+        return 0;
+    }
+
+    // ==================== 超过一个分块：Multipart Upload ====================
+    std::cout << "输入超过一个分块，使用Multipart Upload..." << std::endl;
+    if (!uploader.Begin()) {
+        uploader.ReleaseBuffer(partBuffer);
+        return 1;
+    }
+    std::cout << "Multipart Upload创建成功，Upload ID: " << uploader.UploadId() << std::endl;
+    uploader.SetProgress(&progress);
+    progress.Start();
+
+    unsigned int partNumber = 1;
+    bool readFailed = false;
+    while (true) {
+        if (bytesRead == 0) {
+            uploader.ReleaseBuffer(partBuffer);  // 流长度恰好是分块大小的整数倍
+            break;
+        }
+        if (partNumber > PartPlanner::MAX_PART_COUNT) {
+            std::cerr << "输入超过 " << PartPlanner::MAX_PART_COUNT
+                      << " 个分块，请用--part-size或--memory加大分块" << std::endl;
+            uploader.ReleaseBuffer(partBuffer);
+            readFailed = true;
+            break;
+        }
+        partBuffer->SetSize(bytesRead);
+        progress.AddBytesRead(bytesRead);
+        if (!uploader.SubmitPart(partNumber++, partBuffer) || source.Eof()) {
+            break;  // 已有分块失败，或这是读到EOF的最后一个分块
+        }
+
+        // 上传线程发送已提交分块的同时，主线程读取下一个分块
+        partBuffer = uploader.AcquireBuffer();
+        if (!source.ReadFull(partBuffer->Data(), partBuffer->Capacity(), bytesRead)) {
+            std::cerr << source.LastError() << std::endl;
+            uploader.ReleaseBuffer(partBuffer);
+            readFailed = true;
+            break;
+        }
+    }
+    if (readFailed) {
+        uploader.Abort();  // 流无法重新读取，已上传的分块没有保留价值
+        return 1;
+    }
+
+    bool completed = uploader.Complete();
+    progress.Stop();
+    if (!completed) {
+        std::cerr << "流上传失败: " << uploader.LastError() << std::endl;
+        return 1;
+    }
+
+    MultipartUploader::Stats stats = uploader.GetStats();
+    std::cout << "\n=== 流上传完成 ===" << std::endl;
+    std::cout << "总字节数: " << source.BytesRead() << "，总分块数: " << uploader.PartCount() << std::endl;
+    std::cout << "上传耗时: " << stats.elapsedSeconds << " 秒，吞吐量: "
+              << stats.MegabytesPerSecond() << " MB/s" << std::endl;
+    if (stats.retries > 0) {
+        std::cout << "请求重试次数: " << stats.retries << std::endl;
+    }
+    PrintBufferPoolStats();
+    std::cout << "最终ETag: " << uploader.Etag() << std::endl;
+    return 0;
+}
+
 int main(int argc, char* argv[]) {
-    // ==================== 命令行参数验证 ====================
+    // ==================== 命令行参数解析 ====================
+    size_t concurrency = 4;  // 大文件同时在途的分块数
+    size_t readAhead = 2;    // 读取线程最多领先上传的分块数
+    bool useMmap = false;    // 是否使用内存映射读取源文件
+    ReaderBackend readerBackend = ReaderBackend::kPread;  // 大文件读取后端
+    size_t queueDepth = 8;   // io_uring在途读请求数
+    bool directIO = false;   // 是否以O_DIRECT读取
+    size_t fixedPartSize = 0;                 // 固定分块大小，0表示自动规划
+    size_t memoryBudget = 256 * 1024 * 1024;  // 暂存缓冲区内存预算
+    bool adaptivePartSize = false;            // 是否运行期自适应分块大小
+    bool resumeMode = false;                  // 是否启用断点续传
+    RetryPolicy retryPolicy;                  // 单个请求的重试策略
+    size_t retryBudget = MultipartUploader::DEFAULT_RETRY_BUDGET;  // 整个上传的重试总次数
+    std::string objectOverride;               // -o 指定的目标对象名
+    int inputFd = -1;                         // --fd 指定的输入文件描述符
+    ProgressMode progressMode = ProgressReporter::DefaultMode();  // 进度输出方式
+    bool dedupMode = false;                   // 是否启用秒传去重
+    bool hashMode = false;                    // 是否在上传的同时计算摘要
+    bool verifyIntegrity = false;             // 是否校验Content-MD5和ETag
+    uint64_t limitRate = 0;                   // 上传带宽上限（字节/秒），0表示不限
+    TrafficClass trafficClass = TrafficClass::kBulk;  // 本进程流量的优先级
+    int compressLevel = 0;                    // zstd压缩级别，0表示不压缩
+    size_t compressThreads = std::thread::hardware_concurrency();  // 压缩/加密线程数
+    std::string encryptKeyFile;               // 客户端加密的主密钥文件，空表示不加密
+    static const option longOptions[] = {
+        {"object", required_argument, nullptr, 'o'},
+        {"jobs", required_argument, nullptr, 'j'},
+        {"read-ahead", required_argument, nullptr, 'r'},
+        {"mmap", no_argument, nullptr, 'm'},
+        {"reader", required_argument, nullptr, OPT_READER},
+        {"queue-depth", required_argument, nullptr, OPT_QUEUE_DEPTH},
+        {"direct", no_argument, nullptr, OPT_DIRECT},
+        {"part-size", required_argument, nullptr, OPT_PART_SIZE},
+        {"memory", required_argument, nullptr, OPT_MEMORY},
+        {"adaptive", no_argument, nullptr, OPT_ADAPTIVE},
+        {"resume", no_argument, nullptr, OPT_RESUME},
+        {"retries", required_argument, nullptr, OPT_RETRIES},
+        {"retry-budget", required_argument, nullptr, OPT_RETRY_BUDGET},
+        {"fd", required_argument, nullptr, OPT_FD},
+        {"progress", required_argument, nullptr, OPT_PROGRESS},
+        {"dedup", no_argument, nullptr, OPT_DEDUP},
+        {"hash", no_argument, nullptr, OPT_HASH},
+        {"verify", no_argument, nullptr, OPT_VERIFY},
+        {"limit-rate", required_argument, nullptr, OPT_LIMIT_RATE},
+        {"priority", required_argument, nullptr, OPT_PRIORITY},
+        {"compress", optional_argument, nullptr, OPT_COMPRESS},
+        {"compress-threads", required_argument, nullptr, OPT_COMPRESS_THREADS},
+        {"encrypt-key", required_argument, nullptr, OPT_ENCRYPT_KEY},
+        {"huge-pages", no_argument, nullptr, OPT_HUGE_PAGES},
+        {nullptr, 0, nullptr, 0},
+    };
+    int opt;
+    while ((opt = getopt_long(argc, argv, "o:j:r:m", longOptions, nullptr)) != -1) {
+        switch (opt) {
+        case 'o':
+            objectOverride = optarg;
+            break;
+        case 'j':
+            concurrency = std::strtoul(optarg, nullptr, 10);
+            break;
+        case 'r':
+            readAhead = std::strtoul(optarg, nullptr, 10);
+            break;
+        case 'm':
+            useMmap = true;
+            break;
+        case OPT_READER:
+            if (std::string(optarg) == "uring") {
+                readerBackend = ReaderBackend::kUring;
+            } else if (std::string(optarg) == "pread") {
+                readerBackend = ReaderBackend::kPread;
+            } else {
+                PrintUsage(argv[0]);
+                return 1;
+            }
+            break;
+        case OPT_QUEUE_DEPTH:
+            queueDepth = std::strtoul(optarg, nullptr, 10);
+            break;
+        case OPT_DIRECT:
+            directIO = true;
+            break;
+        case OPT_PART_SIZE:
+            fixedPartSize = std::strtoul(optarg, nullptr, 10) * PartPlanner::MB;
+            break;
+        case OPT_MEMORY:
+            memoryBudget = std::strtoul(optarg, nullptr, 10) * PartPlanner::MB;
+            break;
+        case OPT_ADAPTIVE:
+            adaptivePartSize = true;
+            break;
+        case OPT_RESUME:
+            resumeMode = true;
+            break;
+        case OPT_RETRIES:
+            retryPolicy.maxAttempts = std::strtoul(optarg, nullptr, 10);
+            break;
+        case OPT_RETRY_BUDGET:
+            retryBudget = std::strtoul(optarg, nullptr, 10);
+            break;
+        case OPT_FD:
+            inputFd = static_cast<int>(std::strtol(optarg, nullptr, 10));
+            break;
+        case OPT_DEDUP:
+            dedupMode = true;
+            break;
+        case OPT_HASH:
+            hashMode = true;
+            break;
+        case OPT_VERIFY:
+            verifyIntegrity = true;
+            break;
+        case OPT_PROGRESS:
+            if (!ProgressReporter::ParseMode(optarg, progressMode)) {
+                PrintUsage(argv[0]);
+                return 1;
+            }
+            break;
+        case OPT_LIMIT_RATE:
+            if (!BandwidthGovernor::ParseRate(optarg, limitRate)) {
+                PrintUsage(argv[0]);
+                return 1;
+            }
+            break;
+        case OPT_PRIORITY:
+            if (!BandwidthGovernor::ParseClass(optarg, trafficClass)) {
+                PrintUsage(argv[0]);
+                return 1;
+            }
+            break;
+        case OPT_COMPRESS:
+            compressLevel = optarg != nullptr ? std::atoi(optarg) : PartCompressor::DEFAULT_LEVEL;
+            if (compressLevel <= 0) {
+                PrintUsage(argv[0]);
+                return 1;
+            }
+            break;
+        case OPT_COMPRESS_THREADS:
+            compressThreads = std::strtoul(optarg, nullptr, 10);
+            break;
+        case OPT_ENCRYPT_KEY:
+            encryptKeyFile = optarg;
+            break;
+        case OPT_HUGE_PAGES:
+            BufferPool::Instance().SetHugePages(true);
+            break;
+        default:
+            PrintUsage(argv[0]);
+            return 1;
+        }
+    }
     // 检查用户是否提供了正确的命令行参数
-    if (argc != 2) {
-        std::cerr << "使用方法: " << argv[0] << " <source_file>" << std::endl;
+    // 使用--fd时不再需要源文件参数
+    if (optind != argc - (inputFd >= 0 ? 0 : 1) || concurrency == 0) {
+        PrintUsage(argv[0]);
+        return 1;
+    }
+    std::string sourceFile = inputFd >= 0 ? "" : argv[optind];  // 获取要上传的源文件路径
+    bool streamInput = inputFd >= 0 || sourceFile == "-";       // 是否从长度未知的流读取
+    if (streamInput && objectOverride.empty()) {
+        std::cerr << "从流读取时必须用 -o 指定目标对象名" << std::endl;
+        return 1;
+    }
+    if (streamInput && resumeMode) {
+        std::cerr << "流输入无法重新读取，不支持--resume" << std::endl;
+        return 1;
+    }
+    // 去重要在上传前读完整个文件算摘要，摘要由文件上传路径的哈希线程计算，流输入都不支持
+    if (streamInput && (dedupMode || hashMode)) {
+        std::cerr << "流输入不支持--dedup、--hash" << std::endl;
+        return 1;
+    }
+    // 压缩、加密后的分块边界与原始数据无关，续传、去重和摘要都以原始内容为准，不能组合使用
+    bool transformInput = compressLevel > 0 || !encryptKeyFile.empty();
+    if (transformInput && (resumeMode || dedupMode || hashMode)) {
+        std::cerr << "--compress、--encrypt-key 不能与 --resume、--dedup、--hash 同时使用"
+                  << std::endl;
+        return 1;
+    }
+    if (compressLevel > 0 && !PartCompressor::Available()) {
+        std::cerr << "编译时未启用zstd支持，不能使用--compress" << std::endl;
+        return 1;
+    }
+    std::string masterKey;
+    std::string keyError;
+    if (!encryptKeyFile.empty() && !ObjectCipher::LoadKey(encryptKeyFile, masterKey, keyError)) {
+        std::cerr << keyError << std::endl;
         return 1;
     }
-    std::string sourceFile = argv[1];  // 获取要上传的源文件路径
 
     // ==================== MinIO服务器连接配置 ====================
-    // 配置MinIO服务器连接参数，根据实际环境修改
-    std::string minioEndpoint = "localhost:9000";  // MinIO服务器地址和端口
-    std::string accessKey = "minioadmin";           // 访问密钥ID
-    std::string secretKey = "minioadmin";           // 秘密访问密钥
-    bool useSSL = false;                            // 是否使用SSL/TLS加密连接
+    // 配置MinIO服务器连接参数，根据实际环境修改（见minio_connection.h中的默认值）
+    MinioConfig config;
+
+    // 创建MinIO客户端实例（小文件路径使用；大文件路径由上传器为每个线程单独创建）
+    MinioConnection connection(config);
+    minio::s3::Client& minio = connection.Client();
 
-    // 创建MinIO客户端实例
-    // 1. 创建基础URL对象，封装服务器地址和协议信息
-    minio::s3::BaseUrl baseUrl(minioEndpoint, useSSL);
-    // 2. 创建静态凭证提供者，管理访问密钥
-    minio::creds::StaticProvider provider(accessKey, secretKey);
-    // 3. 创建MinIO客户端，这是所有操作的核心接口
-    minio::s3::Client minio(baseUrl, &provider);
+    // 带宽控制：未限速时不设置进度回调，数据路径上没有额外开销
+    BandwidthGovernor governor(limitRate);
+    std::unique_ptr<BandwidthGovernor::Transfer> bandwidth;
+    if (limitRate > 0) {
+        bandwidth = governor.NewTransfer(trafficClass);
+    }
 
     // ==================== 流模式上传配置 ====================
     // 定义上传目标和分块参数
     std::string bucketName = "video";                       // 目标存储桶名称
-    std::string objectName = sourceFile;                    // 对象名称（使用源文件名）
-    const size_t CHUNK_SIZE = 32 * 1024;                   // 32KB - 模拟Web客户端分块大小
+    std::string objectName = objectOverride.empty() ? sourceFile : objectOverride;  // 对象名称（默认使用源文件名）
+    const size_t IO_SIZE = 1024 * 1024;                    // 1MB - io_uring单个读请求大小
     const size_t MIN_PART_SIZE = 5 * 1024 * 1024;          // 5MB - MinIO Multipart Upload最小分块要求
     
     try {
+        // ==================== 流输入（标准输入、管道、--fd）或压缩、加密上传 ====================
+        // 变换后的长度事先未知，文件输入也按流的方式读取和分块
+        if (streamInput || transformInput) {
+            StreamSource source;
+            if (inputFd >= 0) {
+                source.Attach(inputFd);
+            } else if (!source.Open(sourceFile)) {
+                std::cerr << source.LastError() << std::endl;
+                return 1;
+            }
+            size_t streamPartSize =
+                PartPlanner::StreamPartSize(concurrency + readAhead, memoryBudget, fixedPartSize);
+
+            // 处理链：原始输入 -> [压缩] -> [加密] -> 上传，先压缩后加密
+            SequentialSource* upload = &source;
+            std::map<std::string, std::string> userMetadata;
+            std::unique_ptr<PartCompressor> compressor;
+            if (compressLevel > 0) {
+                compressor = std::make_unique<PartCompressor>(*upload, compressThreads, compressLevel);
+                upload = compressor.get();
+                userMetadata[PartCompressor::CODEC_METADATA_KEY] = PartCompressor::CODEC_ZSTD;
+                std::cout << "zstd压缩级别: " << compressLevel << "，压缩线程数: " << compressThreads
+                          << std::endl;
+            }
+            ObjectCipher cipher;
+            std::unique_ptr<PartEncryptor> encryptor;
+            if (!masterKey.empty()) {
+                if (!cipher.InitNew(masterKey, ObjectCipher::DEFAULT_RECORD_SIZE, keyError)) {
+                    std::cerr << keyError << std::endl;
+                    return 1;
+                }
+                encryptor = std::make_unique<PartEncryptor>(*upload, cipher, compressThreads);
+                upload = encryptor.get();
+                userMetadata[ObjectCipher::METADATA_KEY] = ObjectCipher::ALGORITHM;
+                std::cout << "客户端加密: AES-256-GCM，加密线程数: " << compressThreads << std::endl;
+            }
+
+            int result = UploadFromStream(*upload, connection, config, bucketName, objectName,
+                                          concurrency, readAhead, streamPartSize, retryPolicy,
+                                          retryBudget, progressMode, verifyIntegrity,
+                                          bandwidth.get(), userMetadata);
+            if (result == 0 && compressor && compressor->BytesRead() > 0) {
+                std::cout << "原始字节数: " << compressor->BytesIn() << "，压缩后: "
+                          << compressor->BytesRead() << "，压缩比: "
+                          << static_cast<double>(compressor->BytesIn()) / compressor->BytesRead()
+                          << std::endl;
+            }
+            return result;
+        }
+
         // ==================== 文件存在性检查 ====================
         // 在开始处理前确保源文件存在且可访问
         std::ifstream checkFile(sourceFile);
@@ -73,58 +567,130 @@ int main(int argc, char* argv[]) {
         size_t totalSize = sizeCheckFile.tellg();  // tellg()返回当前位置，即文件大小
         sizeCheckFile.close();
         
+        // ==================== 内存映射（可选）====================
+        // 映射后上传数据直接引用映射区，不再经过read()拷贝和iostream缓冲
+        MappedFile mappedFile;
+        if (useMmap) {
+            if (!mappedFile.Open(sourceFile)) {
+                std::cerr << mappedFile.LastError() << std::endl;
+                return 1;
+            }
+            totalSize = mappedFile.Size();
+        }
+        
         // ==================== 开始处理提示信息 ====================
         // 显示当前处理任务的详细信息
         std::cout << "=== 开始模拟web上传流式传输 ===" << std::endl;
         std::cout << "源文件: " << sourceFile << std::endl;
         std::cout << "目标位置: " << bucketName << "/" << objectName << std::endl;
-        std::cout << "每次读取: " << CHUNK_SIZE << " 字节 (" << CHUNK_SIZE / 1024 << "KB)" << std::endl;
+        if (useMmap) {
+            std::cout << "读取方式: 内存映射 (mmap)" << std::endl;
+        } else {
+            std::cout << "读取方式: " << (readerBackend == ReaderBackend::kUring ? "io_uring" : "pread")
+                      << (directIO ? " + O_DIRECT" : "") << std::endl;
+        }
         std::cout << "文件总大小: " << totalSize << " 字节 (" << totalSize / 1024 << "KB)" << std::endl;
         
+        // ==================== 秒传去重检查（可选）====================
+        // 先顺序读一遍文件计算内容摘要，去重索引命中时服务端复制，不再上传任何数据
+        DedupIndex dedupIndex(connection, bucketName);
+        std::string contentDigest;
+        if (dedupMode) {
+            std::string error;
+            auto hashStart = std::chrono::steady_clock::now();
+            if (!ContentHasher::HashFile(sourceFile, contentDigest, error)) {
+                std::cerr << error << std::endl;
+                return 1;
+            }
+            double hashSeconds =
+                std::chrono::duration<double>(std::chrono::steady_clock::now() - hashStart).count();
+            std::cout << "内容摘要(SHA-256): " << contentDigest << "，耗时 " << hashSeconds << " 秒"
+                      << std::endl;
+
+            std::string existingObject;
+            std::string existingEtag;
+            if (dedupIndex.Lookup(contentDigest, totalSize, existingObject, existingEtag, error)) {
+                if (existingObject == objectName) {
+                    std::cout << "\n=== 秒传完成 ===" << std::endl;
+                    std::cout << "目标对象已存在且内容相同，无需上传" << std::endl;
+                    return 0;
+                }
+                std::string etag;
+                if (dedupIndex.CopyTo(existingObject, existingEtag, objectName, etag, error)) {
+                    std::cout << "\n=== 秒传完成 ===" << std::endl;
+                    std::cout << "内容与已有对象 " << existingObject << " 相同，已在服务端复制" << std::endl;
+                    std::cout << "ETag: " << (etag.empty() ? "无" : etag) << std::endl;
+                    return 0;
+                }
+                std::cerr << "警告: " << error << "，改为正常上传" << std::endl;
+            } else if (!error.empty()) {
+                std::cerr << "警告: " << error << "，改为正常上传" << std::endl;
+            }
+        }
+        
+        // ==================== 与上传并行的摘要计算（可选）====================
+        // 秒传模式下也开启：上传完成后用并行算出的摘要核对文件在上传期间没有被修改
+        // 哈希线程引用上传缓冲区，须先于上传器声明、后于上传器析构
+        std::unique_ptr<PartHasher> hasher;
+        if (hashMode || dedupMode) {
+            hasher = std::make_unique<PartHasher>();
+        }
+        
         // ==================== 处理策略选择：根据文件大小决定上传方式 ====================
         if (totalSize < MIN_PART_SIZE) {
             // ==================== 小文件处理路径（< 5MB）====================
-            // 策略：先将整个文件按32KB分块读取到内存，然后一次性上传
-            // 优点：实现简单，适合小文件；缺点：内存占用等于文件大小
+            // 策略：按totalSize一次分配缓冲区，一次read读入整个文件，请求体直接引用这块内存
+            // 优点：整条路径只有一次文件读取，没有追加扩容和字符串转换；缺点：内存占用等于文件大小
             std::cout << "\n文件小于5MB，使用普通PutObject上传..." << std::endl;
             
-            // 打开源文件用于读取，使用二进制模式避免文本模式的换行符转换
-            std::ifstream file(sourceFile, std::ios::binary);
-            std::vector<char> allData;           // 总数据缓冲区，存储整个文件内容
-            std::vector<char> buffer(CHUNK_SIZE); // 32KB读取缓冲区，用于分块读取
-            size_t totalRead = 0;                // 已读取的总字节数，用于进度跟踪
-            
-            // ==================== 分块读取阶段 ====================
-            // 按32KB块循环读取文件，模拟Web客户端分块上传的数据接收过程
-            while (file.read(buffer.data(), CHUNK_SIZE) || file.gcount() > 0) {
-                size_t bytesRead = file.gcount();  // 获取实际读取的字节数（最后一块可能不足32KB）
-                totalRead += bytesRead;            // 累计已读取字节数
+            PartBuffer allData(useMmap ? 0 : totalSize);  // 总数据缓冲区，按文件大小一次分配
+            std::string_view objectData;                    // 待上传的数据视图
+            if (useMmap) {
+                // 整个文件就是映射区，预读后直接引用，不需要缓冲区
+                mappedFile.Prefetch(0, totalSize);
+                objectData = mappedFile.View(0, totalSize);
+            } else {
+                // ==================== 读取阶段 ====================
+                // 打开源文件用于读取，使用二进制模式避免文本模式的换行符转换
+                // 整个文件一次读入缓冲区（小于5MB，单次read即可）
+                std::ifstream file(sourceFile, std::ios::binary);
+                file.read(allData.Data(), totalSize);
+                allData.SetSize(file.gcount());      // 以实际读取的字节数为准
+                file.close();  // 关闭文件，释放文件句柄
+                objectData = allData.View();
                 
-                // 显示读取进度，模拟服务端接收Web客户端数据的过程
-                std::cout << "从文件读取到内存: " << bytesRead << " 字节 (总计: " 
-                          << totalRead << "/" << totalSize << ")" << std::endl;
-                
-                // 将当前读取的数据追加到总缓冲区
-                // 注意：只追加实际读取的字节数，避免添加未使用的缓冲区空间
-                allData.insert(allData.end(), buffer.begin(), buffer.begin() + bytesRead);
+                std::cout << "从文件读取到内存: " << allData.Size() << " 字节 (总计: " 
+                          << allData.Size() << "/" << totalSize << ")" << std::endl;
             }
-            file.close();  // 关闭文件，释放文件句柄
-            
             std::cout << "所有数据已读取到内存，开始从内存上传到MinIO..." << std::endl;
             
-            // ==================== 内存数据转换和上传阶段 ====================
-            // 将vector<char>转换为string，再创建istringstream供MinIO SDK使用
-            std::string dataStr(allData.begin(), allData.end());  // 转换为字符串
-            std::istringstream dataStream(dataStr);               // 创建字符串输入流
-            
-            // 创建PutObject参数对象
-            // 参数说明：数据流、文件大小、分块大小（0表示让SDK自动处理）
-            minio::s3::PutObjectArgs args(dataStream, allData.size(), 0);
+            // ==================== 内存数据上传阶段 ====================
+            // PutObjectApiArgs以string_view作为请求体：Client::PutObject(PutObjectArgs)即使
+            // 对象很小也要分配5MB分块缓冲区并从流中拷贝一遍，这里数据原样发出
+            minio::s3::PutObjectApiArgs args;
             args.bucket = bucketName;  // 设置目标存储桶
             args.object = objectName;  // 设置目标对象名称
+            args.data = objectData;    // 缓冲区或映射区，上传返回前保持有效
+            
+            // 完整性校验：服务端按Content-MD5校验收到的数据，单次PutObject的ETag就是内容MD5
+            std::string md5Hex = verifyIntegrity ? AddContentMd5(args, objectData) : "";
+            if (dedupMode) {
+                // 对象上记录内容摘要，去重索引命中时据此核对对象没有被覆盖
+                args.headers.Add(std::string("x-amz-meta-") + DedupIndex::DIGEST_METADATA_KEY,
+                                 contentDigest);
+            }
+            if (bandwidth) {
+                args.progressfunc = bandwidth->UploadMeter();
+            }
             
             // 执行上传操作
-            minio::s3::PutObjectResponse resp = minio.PutObject(args);
+            if (hasher) {
+                hasher->Submit(1, objectData, nullptr);  // 与PutObject同时读取同一块内存
+            }
+            minio::s3::PutObjectResponse resp = PutObjectDirect(minio, args);
+            if (hasher) {
+                hasher->Wait();
+            }
             if (!resp) {
                 std::cerr << "文件上传失败: " << resp.Error().String() << std::endl;
                 return 1;
@@ -134,117 +700,281 @@ int main(int argc, char* argv[]) {
             std::cout << "\n=== 小文件上传完成 ===" << std::endl;
             std::cout << "文件上传成功！" << std::endl;
             std::cout << "ETag: " << (resp.etag.empty() ? "无" : resp.etag) << std::endl;
+            if (verifyIntegrity) {
+                if (TrimEtag(resp.etag) != md5Hex) {
+                    std::cerr << "ETag校验失败: 服务端 " << resp.etag << "，本地MD5 " << md5Hex << std::endl;
+                    return 1;
+                }
+                std::cout << "ETag校验通过" << std::endl;
+            }
             
         } else {
             // ==================== 大文件处理路径（>= 5MB）====================
-            // 策略：使用MinIO Multipart Upload API，按32KB读取并累积到5MB后分块上传
-            // 优点：内存占用恒定（最大5MB+32KB），支持超大文件；缺点：实现复杂
+            // 策略：使用MinIO Multipart Upload API，分块大小由规划器根据文件大小和内存预算决定
+            // 优点：多个分块并发上传，内存占用恒定（(并发数+预读深度)*分块大小），支持超大文件
             std::cout << "\n文件大于等于5MB，使用Multipart Upload..." << std::endl;
             
-            // ==================== 步骤1：初始化Multipart Upload会话 ====================
-            // 创建Multipart Upload会话，获取upload_id用于后续所有分块操作
-            minio::s3::CreateMultipartUploadArgs createArgs;
-            createArgs.bucket = bucketName;  // 设置目标存储桶
-            createArgs.object = objectName;  // 设置目标对象名称
-            
-            // 发起Multipart Upload创建请求
-            minio::s3::CreateMultipartUploadResponse createResp = minio.CreateMultipartUpload(createArgs);
-            if (!createResp) {
-                std::cerr << "创建Multipart Upload失败: " << createResp.Error().String() << std::endl;
-                return 1;
+            // ==================== 断点续传日志（可选）====================
+            // 日志记录的源文件大小、修改时间和目标都一致时才续传，分块大小沿用日志中的值
+            std::string journalPath = UploadJournal::PathFor(sourceFile);
+            UploadJournal::State journalState;
+            UploadJournal::State currentState;
+            currentState.bucket = bucketName;
+            currentState.object = objectName;
+            currentState.fileSize = totalSize;
+            struct stat sourceStat;
+            if (::stat(sourceFile.c_str(), &sourceStat) == 0) {
+                currentState.fileMtime = sourceStat.st_mtime;
+            }
+            bool resuming = false;
+            if (resumeMode) {
+                adaptivePartSize = false;  // 续传要求分块边界固定，日志只记录一个分块大小
+                if (UploadJournal::Load(journalPath, journalState)) {
+                    if (journalState.bucket == currentState.bucket &&
+                        journalState.object == currentState.object &&
+                        journalState.fileSize == currentState.fileSize &&
+                        journalState.fileMtime == currentState.fileMtime) {
+                        resuming = true;
+                        fixedPartSize = journalState.partSize;
+                    } else {
+                        // 源文件或目标已变化：中止旧的upload，避免服务端残留分块
+                        std::cout << "源文件或目标已变化，放弃旧的续传记录" << std::endl;
+                        minio::s3::AbortMultipartUploadArgs abortArgs;
+                        abortArgs.bucket = journalState.bucket;
+                        abortArgs.object = journalState.object;
+                        abortArgs.upload_id = journalState.uploadId;
+                        minio.AbortMultipartUpload(abortArgs);
+                    }
+                }
             }
             
-            // 获取上传会话ID，所有后续的分块上传都需要这个ID
-            std::string uploadId = createResp.upload_id;
-            std::cout << "Multipart Upload创建成功，Upload ID: " << uploadId << std::endl;
+            // ==================== 分块大小规划 ====================
+            // 10000分块上限决定最小分块，内存预算决定最大分块；记录选择结果便于调优
+            PartPlanner planner(totalSize, concurrency, concurrency + readAhead, memoryBudget,
+                                fixedPartSize, adaptivePartSize);
+            const PartPlanner::Plan& plan = planner.GetPlan();
+            std::cout << "分块大小: " << plan.partSize / PartPlanner::MB << "MB"
+                      << (planner.Adaptive() ? "（自适应，上限 " + std::to_string(plan.maxPartSize / PartPlanner::MB) + "MB）" : "")
+                      << "，预计请求数: " << plan.partCount
+                      << "，暂存内存: " << plan.memoryBytes / PartPlanner::MB << "MB" << std::endl;
+            if (plan.overBudget) {
+                std::cerr << "警告: 为满足10000分块上限，暂存内存超出预算 "
+                          << memoryBudget / PartPlanner::MB << "MB" << std::endl;
+            }
             
-            // ==================== 步骤2：分块读取和上传循环 ====================
-            // 打开文件进行分块读取处理
-            std::ifstream file(sourceFile, std::ios::binary);
-            std::list<minio::s3::Part> parts;                   // 已完成分块列表，用于最终合并
-            std::vector<char> partBuffer;                       // 分块累积缓冲区，最大5MB
-            std::vector<char> readBuffer(CHUNK_SIZE);           // 32KB读取缓冲区，固定大小
-            size_t totalRead = 0;                              // 已读取的总字节数
-            int partNumber = 1;                                // 分块编号，从1开始
+            // ==================== 步骤1：初始化Multipart Upload会话 ====================
+            // 创建并发上传器，获取upload_id用于后续所有分块操作
+            // mmap模式下分块直接引用映射区，不需要暂存缓冲区
+            // 续传日志和进度报告先于上传器声明：上传器析构时等待在途分块，其回调仍会用到它们
+            UploadJournal journal;
+            ProgressReporter progress(progressMode, totalSize);
+            MultipartUploader uploader(config, bucketName, objectName, concurrency,
+                                       useMmap ? 0 : plan.maxPartSize, readAhead);
+            uploader.SetPartCallback([&](unsigned int partNumber, size_t bytes,
+                                         const std::string& etag, double seconds) {
+                planner.ObservePart(bytes, seconds);  // 自适应模式根据实测耗时调整后续分块
+                if (resumeMode && !journal.RecordPart(partNumber, bytes, etag)) {
+                    std::cerr << "警告: " << journal.LastError() << std::endl;
+                }
+            });
+            uploader.SetRetryPolicy(retryPolicy, retryBudget);
+            if (dedupMode) {
+                uploader.AddHeader(std::string("x-amz-meta-") + DedupIndex::DIGEST_METADATA_KEY,
+                                   contentDigest);
+            }
+            // 续传模式下失败时保留服务端分块，下次运行从日志继续；否则中止上传释放存储
+            uploader.SetAbortOnFailure(!resumeMode);
             
-            // 主循环：按32KB读取文件，累积到5MB后上传分块
-            while (file.read(readBuffer.data(), CHUNK_SIZE) || file.gcount() > 0) {
-                size_t bytesRead = file.gcount();  // 获取实际读取字节数
-                totalRead += bytesRead;            // 累计总读取字节数
-                
-                // 显示读取进度，模拟服务端接收Web客户端分块数据
-                std::cout << "从文件读取到内存: " << bytesRead << " 字节 (总计: " 
-                          << totalRead << "/" << totalSize << ")" << std::endl;
-                
-                // 将当前读取的32KB数据追加到分块缓冲区
-                partBuffer.insert(partBuffer.end(), readBuffer.begin(), readBuffer.begin() + bytesRead);
-                
-                // ==================== 分块上传条件判断 ====================
-                // 条件1：缓冲区达到5MB（MinIO最小分块要求）
-                // 条件2：文件读取完毕（处理最后一个可能不足5MB的分块）
-                bool isLastPart = (totalRead >= totalSize);
-                if (partBuffer.size() >= MIN_PART_SIZE || isLastPart) {
-                    std::cout << "从内存上传分块 " << partNumber << " 到MinIO，大小: " 
-                              << partBuffer.size() << " 字节" << std::endl;
-                    
-                    // 将数据从vector转换为string，然后创建string_view
-                    std::string partDataStr(partBuffer.begin(), partBuffer.end());
-                    std::string_view partData(partDataStr);
-                    
-                    minio::s3::UploadPartArgs uploadPartArgs;
-                    uploadPartArgs.bucket = bucketName;
-                    uploadPartArgs.object = objectName;
-                    uploadPartArgs.upload_id = uploadId;
-                    uploadPartArgs.part_number = partNumber;
-                    uploadPartArgs.data = partData;
-                    
-                    // 立即上传，确保partDataStr在作用域内
-                    minio::s3::UploadPartResponse uploadPartResp = minio.UploadPart(uploadPartArgs);
-                    if (!uploadPartResp) {
-                        std::cerr << "分块 " << partNumber << " 上传失败: " 
-                                  << uploadPartResp.Error().String() << std::endl;
+            // 续传：与服务端ListParts核对，只有日志和服务端都有、且ETag一致的分块才跳过
+            std::set<unsigned int> confirmedParts;
+            if (resuming) {
+                ListPartsResult listed;
+                std::string error;
+                if (ListParts(connection, bucketName, objectName, journalState.uploadId, listed, error)) {
+                    std::vector<minio::s3::Part> confirmed;
+                    for (const minio::s3::Part& part : listed.parts) {
+                        auto it = journalState.parts.find(part.number);
+                        if (it != journalState.parts.end() && TrimEtag(it->second.etag) == part.etag &&
+                            it->second.size == part.size) {
+                            confirmed.push_back(part);
+                            confirmedParts.insert(part.number);
+                        }
+                    }
+                    uploader.Resume(journalState.uploadId, confirmed);
+                    if (!journal.OpenForAppend(journalPath)) {
+                        std::cerr << journal.LastError() << std::endl;
                         return 1;
                     }
-                    
-                    // 记录完成的分块
-                    minio::s3::Part part;
-                    part.number = partNumber;
-                    part.etag = uploadPartResp.etag;
-                    parts.push_back(part);
-                    
-                    std::cout << "分块 " << partNumber << " 上传成功，ETag: " 
-                              << uploadPartResp.etag << std::endl;
-                    
-                    // 清空缓冲区，准备下一个分块
-                    partBuffer.clear();
-                    partNumber++;
+                    std::cout << "续传Upload ID: " << uploader.UploadId() << "，服务端已确认分块: "
+                              << confirmedParts.size() << " 个" << std::endl;
+                } else if (listed.noSuchUpload) {
+                    std::cout << "服务端已不存在该Upload ID，重新开始上传" << std::endl;
+                    resuming = false;
+                } else {
+                    std::cerr << error << std::endl;
+                    return 1;
                 }
             }
-            file.close();
+            if (!resuming) {
+                if (!uploader.Begin()) {
+                    return 1;
+                }
+                if (resumeMode) {
+                    currentState.partSize = plan.partSize;
+                    currentState.uploadId = uploader.UploadId();
+                    if (!journal.Create(journalPath, currentState)) {
+                        std::cerr << journal.LastError() << std::endl;
+                        uploader.Abort();  // 没有日志就无法续传，不保留这次上传
+                        return 1;
+                    }
+                    std::cout << "续传日志: " << journalPath << std::endl;
+                }
+            }
+            std::cout << "Multipart Upload创建成功，Upload ID: " << uploader.UploadId() << std::endl;
+            std::cout << "并发上传分块数: " << uploader.Concurrency() << "，暂存缓冲区数: "
+                      << uploader.BufferCount() << std::endl;
+            uploader.SetProgress(&progress);
+            uploader.SetHasher(hasher.get());
+            uploader.SetVerifyIntegrity(verifyIntegrity);
+            uploader.SetBandwidth(bandwidth.get());
+            progress.Start();
             
-            // 步骤3：完成Multipart Upload
-            std::cout << "\n完成Multipart Upload..." << std::endl;
-            minio::s3::CompleteMultipartUploadArgs completeArgs;
-            completeArgs.bucket = bucketName;
-            completeArgs.object = objectName;
-            completeArgs.upload_id = uploadId;
-            completeArgs.parts = parts;
+            PartReader::Stats readerStats;
+            if (useMmap) {
+                // ==================== 步骤2：映射区分块直接上传 ====================
+                // 每个分块就是映射区中的一段视图；提交前对后续readAhead个分块发出预读提示，
+                // 上传线程访问时数据已在页缓存中
+                unsigned int partNumber = 1;
+                for (size_t offset = 0; offset < totalSize && !uploader.Failed(); partNumber++) {
+                    size_t partSize = planner.NextPartSize(offset, partNumber);
+                    std::string_view partData = mappedFile.View(offset, partSize);
+                    if (confirmedParts.count(partNumber) > 0) {
+                        offset += partData.size();
+                        progress.AddBytesSkipped(partData.size());
+                        continue;  // 续传：该分块已在服务端
+                    }
+                    mappedFile.Prefetch(offset, partSize * (readAhead + 1));
+                    offset += partData.size();
+                    if (!uploader.SubmitPart(partNumber, partData)) {
+                        break;  // 已有分块失败，停止提交
+                    }
+                }
+            } else {
+                // ==================== 步骤2：读取线程与上传线程流水线 ====================
+                // 独立的读取线程通过读取后端把每个分块直接读入预分配的暂存缓冲区，
+                // 再把缓冲区本身交给上传器；上传第N块的同时，读取线程已在填充第N+1..N+k块
+                std::string warning;
+                std::unique_ptr<FileReader> fileReader =
+                    FileReader::Create(readerBackend, queueDepth, IO_SIZE, warning);
+                if (!warning.empty()) {
+                    std::cerr << "警告: " << warning << std::endl;
+                }
+                if (!fileReader->Open(sourceFile, directIO)) {
+                    std::cerr << fileReader->LastError() << std::endl;
+                    return 1;
+                }
+                if (directIO && !fileReader->Direct()) {
+                    std::cerr << "警告: 文件系统不支持O_DIRECT，使用普通读取" << std::endl;
+                }
+                std::cout << "读取后端: " << fileReader->Name() << std::endl;
+                
+                PartReader reader(*fileReader, totalSize, planner, uploader);
+                reader.SkipParts(confirmedParts);
+                reader.SetProgress(&progress);
+                reader.Start();
+                reader.Join();
+                readerStats = reader.GetStats();
+                if (reader.Failed()) {
+                    std::cerr << "读取源文件失败: " << reader.LastError() << std::endl;
+                    if (!resumeMode) {
+                        uploader.Abort();  // 不提交Complete；等待已提交的分块结束后中止上传
+                    }
+                    return 1;
+                }
+            }
             
-            minio::s3::CompleteMultipartUploadResponse completeResp = minio.CompleteMultipartUpload(completeArgs);
-            if (!completeResp) {
-                std::cerr << "完成Multipart Upload失败: " << completeResp.Error().String() << std::endl;
+            // 步骤3：等待在途分块并完成Multipart Upload
+            bool completed = uploader.Complete();
+            progress.Stop();
+            if (!completed) {
+                std::cerr << "大文件上传失败: " << uploader.LastError() << std::endl;
                 return 1;
             }
             
+            if (resumeMode) {
+                journal.Remove();  // 上传已完成，续传日志不再需要
+            }
+            
+            MultipartUploader::Stats stats = uploader.GetStats();
             std::cout << "\n=== 大文件上传完成 ===" << std::endl;
             std::cout << "文件上传成功！" << std::endl;
-            std::cout << "总分块数: " << parts.size() << std::endl;
-            std::cout << "最终ETag: " << completeResp.etag << std::endl;
-            std::cout << "文件位置: " << completeResp.location << std::endl;
+            std::cout << "总分块数: " << uploader.PartCount() << std::endl;
+            std::cout << "上传耗时: " << stats.elapsedSeconds << " 秒，吞吐量: "
+                      << stats.MegabytesPerSecond() << " MB/s" << std::endl;
+            if (stats.retries > 0) {
+                std::cout << "请求重试次数: " << stats.retries << std::endl;
+            }
+            if (!useMmap) {
+                std::cout << "读盘耗时: " << readerStats.readSeconds << " 秒，等待空闲缓冲区: "
+                          << readerStats.waitSeconds << " 秒" << std::endl;
+            }
+            PrintBufferPoolStats();
+            std::cout << "最终ETag: " << uploader.Etag()
+                      << (uploader.EtagVerified() ? "（本地校验通过）" : "") << std::endl;
+            std::cout << "文件位置: " << uploader.Location() << std::endl;
+        }
+        
+        // ==================== 摘要结果 ====================
+        std::string uploadedDigest;  // 实际上传内容的SHA-256，续传时无法得到
+        if (hasher) {
+            hasher->Wait();
+            std::cout << "哈希线程耗时: " << hasher->BusySeconds() << " 秒（与上传并行）" << std::endl;
+            if (hasher->ObjectDigestComplete()) {
+                uploadedDigest = hasher->ObjectSha256Hex();
+                std::cout << "对象SHA-256: " << uploadedDigest << std::endl;
+            } else {
+                std::cout << "续传跳过了部分分块，只得到本次上传分块的摘要" << std::endl;
+            }
+            if (hashMode) {
+                for (const auto& entry : hasher->PartDigests()) {
+                    std::cout << "分块 " << entry.first << " 大小: " << entry.second.size
+                              << " MD5: " << entry.second.md5Hex << std::endl;
+                }
+            }
+        }
+        
+        // 上传成功后登记到去重索引，之后相同内容的上传可以秒传；
+        // 只有确认上传的内容就是上传前算出的摘要时才登记
+        if (dedupMode) {
+            std::string error;
+            bool digestVerified = uploadedDigest == contentDigest;
+            if (uploadedDigest.empty()) {
+                // 续传：跳过的分块由之前的进程上传，重新读一遍源文件核对内容没有变化
+                std::string rehashed;
+                if (ContentHasher::HashFile(sourceFile, rehashed, error)) {
+                    digestVerified = rehashed == contentDigest;
+                } else {
+                    std::cerr << "警告: " << error << std::endl;
+                }
+            }
+            if (digestVerified) {
+                if (!dedupIndex.Register(contentDigest, objectName, error)) {
+                    std::cerr << "警告: " << error << std::endl;
+                }
+            } else {
+                // 对象带着上传前的摘要：删除该摘要的索引，并去掉对象上的摘要元数据，
+                // 已有的索引不会再把它当成旧内容秒传出去。mmap模式下哈希与上传读的页
+                // 可能不是同一时刻的内容，上传后的摘要也不可信，不写回
+                std::cerr << "警告: 源文件在上传期间被修改，不登记到去重索引" << std::endl;
+                dedupIndex.RemoveStale(contentDigest);
+                if (!dedupIndex.Retag(objectName, std::string(), error)) {
+                    std::cerr << "警告: " << error << std::endl;
+                }
+            }
         }
         
         std::cout << "\n注意：文件已成功上传为完整文件。" << std::endl;
-        std::cout << "这模拟了从文件读取32KB数据到内存，然后从内存上传到MinIO的场景。" << std::endl;
+        std::cout << "这模拟了从文件读取数据到内存，然后从内存上传到MinIO的场景。" << std::endl;
         
     } catch (const std::exception& e) {
         std::cerr << "流模式上传失败: " << e.what() << std::endl;
@@ -0,0 +1,460 @@
+#include "multipart_uploader.h"
+
+#include <iostream>
+#include <memory>
+
+#include "content_hasher.h"
+#include "s3_multipart_api.h"  // TrimEtag
+
+namespace {
+
+std::string ComputeMd5(std::string_view data) {
+    ContentHasher hasher(DigestAlgorithm::kMd5);
+    hasher.Update(data.data(), data.size());
+    return hasher.Final();
+}
+
+}  // namespace
+
+PartWorkerPool::PartWorkerPool(const MinioConfig& config, size_t concurrency,
+                               size_t queueCapacity)
+    : pool_(concurrency == 0 ? 1 : concurrency, queueCapacity) {
+    for (size_t i = 0; i < pool_.ThreadCount(); ++i) {
+        connections_.push_back(std::make_unique<MinioConnection>(config));
+    }
+}
+
+MultipartUploader::MultipartUploader(const MinioConfig& config, std::string bucket,
+                                     std::string object, size_t concurrency, size_t partSize,
+                                     size_t readAhead)
+    : bucket_(std::move(bucket)),
+      object_(std::move(object)),
+      ownedRetryBudget_(std::make_unique<RetryBudget>(DEFAULT_RETRY_BUDGET)),
+      retryBudget_(ownedRetryBudget_.get()),
+      ownedControlConnection_(std::make_unique<MinioConnection>(config)),
+      controlConnection_(ownedControlConnection_.get()),
+      freeBuffers_((concurrency == 0 ? 1 : concurrency) + readAhead) {
+    if (concurrency == 0) {
+        concurrency = 1;
+    }
+    // concurrency个缓冲区在上传，另外readAhead个供读取线程提前填充后续分块
+    CreateBuffers(concurrency + readAhead, partSize);
+    // 缓冲区数量已经限制了在途分块数，排队容量与之相同即可保证Submit不会阻塞
+    ownedWorkers_ = std::make_unique<PartWorkerPool>(config, concurrency, concurrency + readAhead);
+    workers_ = ownedWorkers_.get();
+}
+
+MultipartUploader::MultipartUploader(MinioConnection& control, PartWorkerPool& workers,
+                                     std::string bucket, std::string object, size_t partSize,
+                                     size_t readAhead)
+    : bucket_(std::move(bucket)),
+      object_(std::move(object)),
+      ownedRetryBudget_(std::make_unique<RetryBudget>(DEFAULT_RETRY_BUDGET)),
+      retryBudget_(ownedRetryBudget_.get()),
+      controlConnection_(&control),
+      workers_(&workers),
+      freeBuffers_(workers.Concurrency() + readAhead) {
+    CreateBuffers(workers.Concurrency() + readAhead, partSize);
+}
+
+void MultipartUploader::CreateBuffers(size_t count, size_t partSize) {
+    if (partSize == 0) {
+        return;  // 只上传调用方持有的数据（SubmitPart(string_view)），不占用缓冲区池的内存
+    }
+    for (size_t i = 0; i < count; ++i) {
+        buffers_.push_back(std::make_unique<PartBuffer>(partSize));
+        freeBuffers_.TryPush(buffers_.back().get());
+    }
+}
+
+MultipartUploader::~MultipartUploader() {
+    // 借用的线程池在上传器析构后继续存在，必须等本上传器提交的分块全部结束
+    workers_->pool_.Wait();
+    if (hasher_ != nullptr) {
+        hasher_->Wait();  // 哈希线程仍可能引用缓冲区并回调ReleaseBuffer
+    }
+}
+
+template <typename Response, typename Call>
+bool MultipartUploader::CallWithRetry(const std::string& what, Call call, Response& resp,
+                                      std::string& error) {
+    return RetryCall(retryPolicy_, *retryBudget_, what, call, resp, error);
+}
+
+bool MultipartUploader::Begin() {
+    minio::s3::CreateMultipartUploadArgs createArgs;
+    createArgs.bucket = bucket_;
+    createArgs.object = object_;
+    createArgs.headers = headers_;
+
+    minio::s3::CreateMultipartUploadResponse createResp;
+    std::string error;
+    if (!CallWithRetry("创建Multipart Upload", [&] {
+            return controlConnection_->Client().CreateMultipartUpload(createArgs);
+        }, createResp, error)) {
+        SetError("创建Multipart Upload失败: " + error);
+        return false;
+    }
+
+    uploadId_ = createResp.upload_id;
+    startTime_ = std::chrono::steady_clock::now();
+    return true;
+}
+
+void MultipartUploader::Resume(const std::string& uploadId,
+                               const std::vector<minio::s3::Part>& completedParts) {
+    uploadId_ = uploadId;
+    std::lock_guard<std::mutex> lock(mutex_);
+    for (const minio::s3::Part& part : completedParts) {
+        parts_[part.number] = part;
+    }
+    startTime_ = std::chrono::steady_clock::now();
+}
+
+PartBuffer* MultipartUploader::AcquireBuffer() {
+    PartBuffer* buffer = nullptr;
+    // 快路径：有空闲缓冲区时无锁取出
+    if (!freeBuffers_.TryPop(buffer)) {
+        // 慢路径：全部缓冲区都在上传，登记等待后睡眠，由归还方唤醒
+        std::unique_lock<std::mutex> lock(waitMutex_);
+        readerWaiting_.store(true);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        while (!freeBuffers_.TryPop(buffer)) {
+            bufferReady_.wait(lock);
+        }
+        readerWaiting_.store(false);
+    }
+    buffer->SetSize(0);
+    buffer->SetMd5(std::string());
+    return buffer;
+}
+
+void MultipartUploader::ReleaseBuffer(PartBuffer* buffer) {
+    {
+        // 多个上传线程可能同时归还，SPSC队列要求生产者串行
+        std::lock_guard<std::mutex> lock(releaseMutex_);
+        freeBuffers_.TryPush(buffer);  // 队列容量不小于缓冲区总数，不会失败
+    }
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if (readerWaiting_.load()) {
+        std::lock_guard<std::mutex> lock(waitMutex_);
+        bufferReady_.notify_one();
+    }
+}
+
+bool MultipartUploader::SubmitPart(unsigned int partNumber, PartBuffer* buffer) {
+    if (failed_) {
+        ReleaseBuffer(buffer);
+        return false;
+    }
+    // 完整性校验需要的MD5在暂存阶段算一次，上传线程和哈希线程都直接使用
+    if (verifyIntegrity_ && buffer->Md5().empty()) {
+        buffer->SetMd5(ComputeMd5(buffer->View()));
+    }
+    if (progress_ != nullptr) {
+        progress_->PartStarted();
+    }
+    // 上传与哈希同时读取同一块缓冲区，各持有一个引用，最后结束的一方归还缓冲区
+    auto references = std::make_shared<std::atomic<int>>(hasher_ != nullptr ? 2 : 1);
+    auto release = [this, buffer, references] {
+        if (references->fetch_sub(1) == 1) {
+            ReleaseBuffer(buffer);
+        }
+    };
+    if (hasher_ != nullptr) {
+        hasher_->Submit(partNumber, buffer->View(), release, buffer->Md5());
+    }
+    // 任务只持有缓冲区指针，数据以string_view直接交给UploadPart
+    workers_->pool_.Submit([this, partNumber, buffer, release](size_t workerIndex) {
+        UploadOne(workerIndex, partNumber, buffer->View(), buffer->Md5());
+        release();
+        if (progress_ != nullptr) {
+            progress_->PartFinished();
+        }
+    });
+    return !failed_;
+}
+
+bool MultipartUploader::SubmitPart(unsigned int partNumber, std::string_view data) {
+    if (failed_) {
+        return false;
+    }
+    std::string md5 = verifyIntegrity_ ? ComputeMd5(data) : std::string();
+    if (progress_ != nullptr) {
+        progress_->PartStarted();
+    }
+    if (hasher_ != nullptr) {
+        hasher_->Submit(partNumber, data, nullptr, md5);
+    }
+    workers_->pool_.Submit([this, partNumber, data, md5](size_t workerIndex) {
+        UploadOne(workerIndex, partNumber, data, md5);
+        if (progress_ != nullptr) {
+            progress_->PartFinished();
+        }
+    });
+    return !failed_;
+}
+
+void MultipartUploader::UploadOne(size_t workerIndex, unsigned int partNumber,
+                                  std::string_view data, const std::string& md5) {
+    if (failed_) {
+        return;  // 已有分块失败，剩余分块不再上传
+    }
+
+    minio::s3::UploadPartArgs uploadPartArgs;
+    uploadPartArgs.bucket = bucket_;
+    uploadPartArgs.object = object_;
+    uploadPartArgs.upload_id = uploadId_;
+    uploadPartArgs.part_number = partNumber;
+    uploadPartArgs.data = data;
+
+    // 完整性校验：服务端据Content-MD5校验收到的数据，不符时拒绝该分块
+    if (verifyIntegrity_) {
+        uploadPartArgs.extra_headers.Add("Content-MD5", ContentHasher::ToBase64(md5));
+    }
+
+    // 重试时重新发送同一块缓冲区：缓冲区在本函数返回后才会被归还，数据保持不变
+    std::string what = "分块 " + std::to_string(partNumber);
+    // 进度按SDK回调的已发送字节实时累加；请求失败重试时撤销本次请求已计入的部分
+    // 限速按同一回调的发送增量计量，重试重发的字节同样计入
+    size_t reported = 0;
+    minio::http::ProgressFunction meter;
+    if (bandwidth_ != nullptr) {
+        meter = bandwidth_->UploadMeter();
+    }
+    if (progress_ != nullptr || meter) {
+        uploadPartArgs.progressfunc = [this, &reported,
+                                       meter](minio::http::ProgressFunctionArgs args) {
+            if (meter) {
+                meter(args);
+            }
+            size_t sent = static_cast<size_t>(args.uploaded_bytes);
+            if (progress_ != nullptr && sent > reported) {
+                progress_->AddBytesUploaded(sent - reported);
+                reported = sent;
+            }
+            return true;
+        };
+    }
+    auto rollbackProgress = [this, &reported] {
+        if (progress_ != nullptr && reported > 0) {
+            progress_->RollbackBytesUploaded(reported);
+            reported = 0;
+        }
+    };
+
+    minio::s3::UploadPartResponse uploadPartResp;
+    std::string error;
+    auto partStart = std::chrono::steady_clock::now();
+    bool uploaded = CallWithRetry(what, [&] {
+        rollbackProgress();
+        return workers_->connections_[workerIndex]->Client().UploadPart(uploadPartArgs);
+    }, uploadPartResp, error);
+    double partSeconds =
+        std::chrono::duration<double>(std::chrono::steady_clock::now() - partStart).count();
+    if (!uploaded) {
+        rollbackProgress();
+        SetError(what + " 上传失败: " + error);
+        return;
+    }
+    if (progress_ != nullptr && reported < data.size()) {
+        progress_->AddBytesUploaded(data.size() - reported);  // 回调未必报告到最后一个字节
+    }
+    if (verifyIntegrity_ && TrimEtag(uploadPartResp.etag) != ContentHasher::ToHex(md5)) {
+        SetError(what + " ETag与本地MD5不一致: " + uploadPartResp.etag + " != " +
+                 ContentHasher::ToHex(md5));
+        return;
+    }
+
+    bytesUploaded_ += data.size();
+    if (partCallback_) {
+        partCallback_(partNumber, data.size(), uploadPartResp.etag, partSeconds);
+    }
+
+    minio::s3::Part part;
+    part.number = partNumber;
+    part.etag = uploadPartResp.etag;
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    parts_[partNumber] = part;
+    if (verifyIntegrity_) {
+        partMd5_[partNumber] = md5;
+    }
+    if (progress_ != nullptr) {
+        return;
+    }
+    std::cout << "[线程" << workerIndex << "] 分块 " << partNumber << " 上传成功，大小: "
+              << data.size() << " 字节，ETag: " << uploadPartResp.etag << std::endl;
+}
+
+bool MultipartUploader::Complete() {
+    workers_->pool_.Wait();  // 等待所有在途分块完成
+    if (hasher_ != nullptr) {
+        hasher_->Wait();
+    }
+    endTime_ = std::chrono::steady_clock::now();
+    finished_ = true;
+    if (failed_) {
+        if (abortOnFailure_) {
+            Abort();
+        }
+        return false;
+    }
+
+    // parts_是按分块编号排序的map，直接顺序取出即满足CompleteMultipartUpload要求
+    std::list<minio::s3::Part> parts;
+    for (const auto& entry : parts_) {
+        parts.push_back(entry.second);
+    }
+
+    minio::s3::CompleteMultipartUploadArgs completeArgs;
+    completeArgs.bucket = bucket_;
+    completeArgs.object = object_;
+    completeArgs.upload_id = uploadId_;
+    completeArgs.parts = parts;
+
+    // 某次请求没有拿到明确结果（网络错误、超时、5xx）时，服务端可能已经完成了合并：
+    // 此后的重试会收到NoSuchUpload，且绝不能再Abort
+    bool outcomeUnknown = false;
+    minio::s3::CompleteMultipartUploadResponse completeResp;
+    std::string error;
+    if (!CallWithRetry("完成Multipart Upload", [&] {
+            bool unknownBefore = outcomeUnknown;
+            outcomeUnknown = true;  // SDK抛出异常时同样结果不明
+            minio::s3::CompleteMultipartUploadResponse resp =
+                controlConnection_->Client().CompleteMultipartUpload(completeArgs);
+            outcomeUnknown = unknownBefore || (!resp && IsRetryableResponse(resp));
+            return resp;
+        }, completeResp, error)) {
+        if (outcomeUnknown && completeResp.code == "NoSuchUpload" &&
+            ConfirmCompleted(parts.size(), error)) {
+            std::cerr << "完成Multipart Upload重试时upload id已不存在，对象已按本次分块合成"
+                      << std::endl;
+        } else {
+            SetError("完成Multipart Upload失败: " + error);
+            if (outcomeUnknown) {
+                // 合并可能已经生效，中止只会在成功时返回NoSuchUpload，失败时删掉本该保留的分块
+                std::cerr << "完成Multipart Upload结果不明，不中止，upload id: " << uploadId_
+                          << std::endl;
+            } else if (abortOnFailure_) {
+                Abort();
+            }
+            return false;
+        }
+    } else {
+        etag_ = completeResp.etag;
+        location_ = completeResp.location;
+    }
+
+    if (verifyIntegrity_) {
+        std::string expected = ExpectedEtag();
+        if (expected.empty()) {
+            std::cerr << "警告: 缺少部分分块的MD5，无法校验整体ETag" << std::endl;
+        } else if (TrimEtag(etag_) != expected) {
+            // 对象已经在服务端合成，这里只能报告；调用方决定是否删除重传
+            SetError("整体ETag校验失败: 服务端 " + etag_ + "，本地计算 " + expected);
+            return false;
+        } else {
+            etagVerified_ = true;
+        }
+    }
+    return true;
+}
+
+bool MultipartUploader::ConfirmCompleted(size_t partCount, std::string& error) {
+    minio::s3::StatObjectArgs statArgs;
+    statArgs.bucket = bucket_;
+    statArgs.object = object_;
+
+    minio::s3::StatObjectResponse statResp;
+    std::string statError;
+    if (!CallWithRetry("确认Multipart Upload结果", [&] {
+            return controlConnection_->Client().StatObject(statArgs);
+        }, statResp, statError)) {
+        error += "；查询对象失败: " + statError;
+        return false;
+    }
+
+    // 优先比对完整的整体ETag；分块ETag不是MD5（例如SSE-KMS）时退而比对分块数后缀
+    std::string actual = TrimEtag(statResp.etag);
+    std::string expected = ExpectedEtag();
+    std::string suffix = "-" + std::to_string(partCount);
+    bool matched = expected.empty()
+                       ? actual.size() > suffix.size() &&
+                             actual.compare(actual.size() - suffix.size(), suffix.size(),
+                                            suffix) == 0
+                       : actual == expected;
+    if (!matched) {
+        error += "；服务端对象ETag " + statResp.etag + " 与本次上传不符";
+        return false;
+    }
+    etag_ = statResp.etag;
+    return true;
+}
+
+std::string MultipartUploader::ExpectedEtag() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    ContentHasher composite(DigestAlgorithm::kMd5);
+    for (const auto& entry : parts_) {
+        auto it = partMd5_.find(entry.first);
+        // 续传沿用的分块没有本地MD5，使用服务端确认过的分块ETag（即该分块的MD5）
+        std::string md5 = it != partMd5_.end() ? it->second
+                                               : ContentHasher::FromHex(TrimEtag(entry.second.etag));
+        if (md5.size() != 16) {
+            return std::string();
+        }
+        composite.Update(md5.data(), md5.size());
+    }
+    return composite.FinalHex() + "-" + std::to_string(parts_.size());
+}
+
+void MultipartUploader::Abort() {
+    workers_->pool_.Wait();
+    if (uploadId_.empty()) {
+        return;
+    }
+
+    minio::s3::AbortMultipartUploadArgs abortArgs;
+    abortArgs.bucket = bucket_;
+    abortArgs.object = object_;
+    abortArgs.upload_id = uploadId_;
+
+    minio::s3::AbortMultipartUploadResponse abortResp;
+    std::string error;
+    if (CallWithRetry("中止Multipart Upload", [&] {
+            return controlConnection_->Client().AbortMultipartUpload(abortArgs);
+        }, abortResp, error)) {
+        std::cerr << "已中止Multipart Upload: " << uploadId_ << std::endl;
+    } else {
+        std::cerr << "中止Multipart Upload失败: " << error << "，upload id: " << uploadId_
+                  << std::endl;
+    }
+    uploadId_.clear();
+}
+
+std::string MultipartUploader::LastError() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return lastError_;
+}
+
+MultipartUploader::Stats MultipartUploader::GetStats() const {
+    Stats stats;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stats.partsUploaded = parts_.size();
+    }
+    stats.bytesUploaded = bytesUploaded_;
+    stats.retries = retryBudget_->Used();
+    auto end = finished_ ? endTime_ : std::chrono::steady_clock::now();
+    stats.elapsedSeconds = std::chrono::duration<double>(end - startTime_).count();
+    return stats;
+}
+
+void MultipartUploader::SetError(const std::string& message) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (lastError_.empty()) {
+        lastError_ = message;  // 只保留第一个错误，后续错误通常是连锁反应
+    }
+    std::cerr << message << std::endl;
+    failed_ = true;
+}
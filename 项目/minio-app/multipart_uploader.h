@@ -0,0 +1,239 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <functional>
+#include <list>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <vector>
+#include <miniocpp/client.h>  // MinIO C++ SDK主要头文件
+
+#include "bandwidth_governor.h"
+#include "minio_connection.h"
+#include "part_buffer.h"
+#include "part_hasher.h"
+#include "progress_reporter.h"
+#include "retry_policy.h"
+#include "spsc_queue.h"
+#include "thread_pool.h"
+
+/**
+ * 可复用的分块上传工作线程，每个线程持有一个MinIO连接
+ *
+ * 批量上传时由同一工作线程上的多个MultipartUploader先后借用，不必每个对象重新建立连接、
+ * 启动线程。同一时刻只能借给一个上传器：Complete()等待的是整个线程池。
+ */
+class PartWorkerPool {
+public:
+    // queueCapacity: 排队分块数上限，超过时SubmitPart()阻塞
+    PartWorkerPool(const MinioConfig& config, size_t concurrency, size_t queueCapacity);
+
+    PartWorkerPool(const PartWorkerPool&) = delete;
+    PartWorkerPool& operator=(const PartWorkerPool&) = delete;
+
+    size_t Concurrency() const { return connections_.size(); }
+
+private:
+    friend class MultipartUploader;
+
+    std::vector<std::unique_ptr<MinioConnection>> connections_;  // 每个工作线程一个
+    ThreadPool pool_;  // 最后声明，最先析构：线程退出后才销毁连接
+};
+
+/**
+ * 并发Multipart Upload上传器
+ *
+ * 功能说明：
+ * 1. 在有界线程池上同时保持N个分块处于上传状态，充分利用高带宽链路
+ * 2. 每个工作线程持有独立的MinIO客户端，避免共享Client带来的线程安全问题
+ * 3. 分块完成顺序任意，CompleteMultipartUpload前按分块编号排序
+ * 4. 统计总上传字节数和耗时，给出整体吞吐量
+ * 5. 分块缓冲区（并发数+预读深度个）预先分配并循环复用，调用方把文件直接读进缓冲区，
+ *    上传时以string_view引用缓冲区，全程没有中间拷贝
+ * 6. 空闲缓冲区通过无锁SPSC队列回收：唯一的读取线程取缓冲区时不加锁，
+ *    上传线程归还时用一把短锁串行化成"单生产者"
+ * 7. 单个分块失败时按指数退避+抖动只重传该分块的缓冲区，整个上传共享重试预算；
+ *    重试耗尽后自动AbortMultipartUpload，避免服务端残留分块占用存储；
+ *    CompleteMultipartUpload有一次结果不明后不再中止，重试收到NoSuchUpload时
+ *    StatObject比对整体ETag（或分块数），一致即视为已完成
+ * 8. 可选ProgressReporter：通过SDK的progressfunc实时累加已发送字节和在途分块数，
+ *    设置后不再逐分块打印
+ * 9. 可选PartHasher：分块在上传的同时交给哈希线程计算摘要，缓冲区等两者都结束才归还
+ * 10. 可选完整性校验：提交分块时（暂存阶段，即读取线程上）计算一次分块MD5并记在PartBuffer上，
+ *     上传带上Content-MD5头（服务端收到的数据与MD5不符时拒绝该分块），PartHasher直接复用
+ *     这个MD5；返回的分块ETag与本地MD5比对；Complete后按
+ *     "所有分块MD5拼接后再取MD5-分块数"在本地算出整体ETag，与服务端返回值比对
+ * 11. 可选带宽控制：所有分块请求按发送进度从同一个BandwidthGovernor::Transfer取令牌
+ * 12. 可借用调用方的控制连接和PartWorkerPool、共享调用方的RetryBudget，
+ *     批量上传大量大文件时连接、线程和重试预算在对象之间复用
+ *
+ * 使用流程：
+ *   MultipartUploader uploader(config, bucket, object, 4, partSize);
+ *   uploader.Begin();
+ *   PartBuffer* buffer = uploader.AcquireBuffer();  // 没有空闲缓冲区时阻塞（反压）
+ *   ... 读入buffer->Data()，buffer->SetSize(n) ...
+ *   uploader.SubmitPart(1, buffer);                // 上传完成后缓冲区自动归还
+ *   ...
+ *   uploader.Complete();
+ */
+class MultipartUploader {
+public:
+    struct Stats {
+        size_t partsUploaded = 0;   // 已成功上传的分块数
+        size_t bytesUploaded = 0;   // 已成功上传的字节数
+        size_t retries = 0;         // 全部请求累计重试次数（共享预算时为共享方的累计值）
+        double elapsedSeconds = 0;  // 从Begin()到当前/Complete()的耗时
+
+        double MegabytesPerSecond() const {
+            return elapsedSeconds > 0 ? bytesUploaded / 1024.0 / 1024.0 / elapsedSeconds : 0;
+        }
+    };
+
+    static constexpr size_t DEFAULT_RETRY_BUDGET = 100;  // 默认整个上传最多重试100次
+
+    // 单个分块上传成功后的回调（在上传线程中调用）：分块编号、字节数、ETag、上传耗时
+    using PartCallback = std::function<void(unsigned int partNumber, size_t bytes,
+                                            const std::string& etag, double seconds)>;
+
+    // concurrency: 同时上传的分块数（工作线程数）；partSize: 每个分块缓冲区的容量，
+    // 为0时不创建缓冲区，只能用SubmitPart(string_view)上传调用方持有的数据
+    // readAhead: 上传之外额外的暂存缓冲区数，即读取线程最多能领先上传多少个分块
+    MultipartUploader(const MinioConfig& config, std::string bucket, std::string object,
+                      size_t concurrency, size_t partSize, size_t readAhead = 1);
+    // 借用调用方的连接和工作线程：control用于Create/Complete，两者须比上传器存活更久
+    MultipartUploader(MinioConnection& control, PartWorkerPool& workers, std::string bucket,
+                      std::string object, size_t partSize, size_t readAhead = 1);
+    // 等待在途分块的上传和哈希结束
+    ~MultipartUploader();
+
+    MultipartUploader(const MultipartUploader&) = delete;
+    MultipartUploader& operator=(const MultipartUploader&) = delete;
+
+    // 以下设置须在Begin()之前调用
+    void SetPartCallback(PartCallback callback) { partCallback_ = std::move(callback); }
+    // retryBudget: 整个上传过程允许的重试总次数
+    void SetRetryPolicy(const RetryPolicy& policy, size_t retryBudget) {
+        retryPolicy_ = policy;
+        ownedRetryBudget_ = std::make_unique<RetryBudget>(retryBudget);
+        retryBudget_ = ownedRetryBudget_.get();
+    }
+    // 与调用方共享重试预算（例如整个批次一个），sharedBudget须比上传器存活更久
+    void SetRetryPolicy(const RetryPolicy& policy, RetryBudget* sharedBudget) {
+        retryPolicy_ = policy;
+        retryBudget_ = sharedBudget;
+    }
+    void SetProgress(ProgressReporter* progress) { progress_ = progress; }
+    // hasher须比上传器存活更久
+    void SetHasher(PartHasher* hasher) { hasher_ = hasher; }
+    // transfer须比上传器存活更久
+    void SetBandwidth(BandwidthGovernor::Transfer* transfer) { bandwidth_ = transfer; }
+    // 服务端开启SSE-KMS/SSE-C加密时ETag不是MD5，不能开启校验
+    void SetVerifyIntegrity(bool verify) { verifyIntegrity_ = verify; }
+    // CreateMultipartUpload附带的请求头，例如x-amz-meta-*用户元数据
+    void AddHeader(const std::string& key, const std::string& value) { headers_.Add(key, value); }
+    // 失败时是否自动中止Multipart Upload（续传模式下应保留服务端分块）
+    void SetAbortOnFailure(bool abort) { abortOnFailure_ = abort; }
+
+    // 步骤1：创建Multipart Upload会话，获取upload_id
+    bool Begin();
+
+    // 步骤1（续传）：沿用已有的upload_id，completedParts是服务端已确认的分块，不再重传
+    void Resume(const std::string& uploadId, const std::vector<minio::s3::Part>& completedParts);
+
+    // 取一个空闲的分块缓冲区，所有缓冲区都在上传中时阻塞
+    // 只能由同一个线程（读取线程）调用
+    PartBuffer* AcquireBuffer();
+    // 归还未提交的缓冲区（例如读到文件末尾时没有数据可填）
+    void ReleaseBuffer(PartBuffer* buffer);
+
+    // 步骤2：异步上传一个分块，buffer在上传完成（或失败）后自动归还
+    // 已有分块失败时返回false，调用方应停止继续读取
+    bool SubmitPart(unsigned int partNumber, PartBuffer* buffer);
+
+    // 异步上传一段调用方持有的数据（例如内存映射文件中的区间），
+    // data必须在Complete()返回前保持有效；排队已满时阻塞
+    bool SubmitPart(unsigned int partNumber, std::string_view data);
+
+    // 步骤3：等待所有分块完成，并按分块编号顺序提交CompleteMultipartUpload
+    // 有分块最终失败时返回false，并按SetAbortOnFailure()的设置中止上传；
+    // 合并请求结果不明时不中止，upload id留给调用方续传或清理
+    bool Complete();
+
+    // 等待在途分块结束后中止Multipart Upload，释放服务端已上传的分块
+    void Abort();
+
+    const std::string& UploadId() const { return uploadId_; }
+    const std::string& Etag() const { return etag_; }
+    const std::string& Location() const { return location_; }
+    std::string LastError() const;
+    size_t PartCount() const { return parts_.size(); }
+    size_t Concurrency() const { return workers_->Concurrency(); }
+    size_t BufferCount() const { return buffers_.size(); }
+    bool Failed() const { return failed_; }
+    // Complete()成功且本地算出的整体ETag与服务端一致
+    bool EtagVerified() const { return etagVerified_; }
+    Stats GetStats() const;
+
+private:
+    // md5为暂存阶段算好的分块MD5原始字节，未开启完整性校验时为空
+    void UploadOne(size_t workerIndex, unsigned int partNumber, std::string_view data,
+                   const std::string& md5);
+    void SetError(const std::string& message);
+    // 预分配count个分块缓冲区并放入空闲队列；partSize为0时不分配
+    void CreateBuffers(size_t count, size_t partSize);
+    // Complete重试收到NoSuchUpload后确认对象是否已由本次上传合成，是则记下etag_
+    bool ConfirmCompleted(size_t partCount, std::string& error);
+    // 按分块编号顺序由各分块MD5算出整体ETag；缺少某个分块的MD5时返回空串
+    std::string ExpectedEtag() const;
+
+    // 执行一次S3请求，失败且可重试时按退避策略重试；最终失败返回false并写入error
+    template <typename Response, typename Call>
+    bool CallWithRetry(const std::string& what, Call call, Response& resp, std::string& error);
+
+    const std::string bucket_;
+    const std::string object_;
+    std::string uploadId_;
+    std::string etag_;
+    std::string location_;
+    PartCallback partCallback_;
+    minio::utils::Multimap headers_;
+    RetryPolicy retryPolicy_;
+    std::unique_ptr<RetryBudget> ownedRetryBudget_;
+    RetryBudget* retryBudget_ = nullptr;  // 指向ownedRetryBudget_或调用方共享的预算
+    bool abortOnFailure_ = true;
+    ProgressReporter* progress_ = nullptr;
+    PartHasher* hasher_ = nullptr;
+    BandwidthGovernor::Transfer* bandwidth_ = nullptr;
+    bool verifyIntegrity_ = false;
+    bool etagVerified_ = false;
+    std::map<unsigned int, std::string> partMd5_;  // 暂存阶段算出的分块MD5原始字节，受mutex_保护
+
+    std::unique_ptr<MinioConnection> ownedControlConnection_;
+    MinioConnection* controlConnection_ = nullptr;  // 主线程使用：Create/Complete
+    PartWorkerPool* workers_ = nullptr;              // 自有或借用的工作线程和连接
+
+    std::vector<std::unique_ptr<PartBuffer>> buffers_;  // 全部预分配的分块缓冲区
+    SpscQueue<PartBuffer*> freeBuffers_;                // 当前空闲的缓冲区
+    std::mutex releaseMutex_;                           // 串行化多个归还线程
+    std::mutex waitMutex_;                              // 仅在队列为空、读取线程需要睡眠时使用
+    std::condition_variable bufferReady_;
+    std::atomic<bool> readerWaiting_{false};
+
+    mutable std::mutex mutex_;                           // 保护parts_、lastError_和输出
+    std::map<unsigned int, minio::s3::Part> parts_;      // 分块编号 -> 分块信息，天然有序
+    std::string lastError_;
+    std::atomic<bool> failed_{false};
+    std::atomic<size_t> bytesUploaded_{0};
+    std::chrono::steady_clock::time_point startTime_;
+    std::chrono::steady_clock::time_point endTime_;
+    bool finished_ = false;
+
+    // 最后声明，最先析构：保证工作线程退出后才销毁上面的连接和状态
+    std::unique_ptr<PartWorkerPool> ownedWorkers_;
+};
@@ -0,0 +1,445 @@
+#include "object_cache.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <ctime>
+#include <dirent.h>        // opendir, readdir
+#include <fcntl.h>         // open
+#include <fstream>         // 读取元数据
+#include <map>
+#include <sstream>
+#include <sys/file.h>      // flock
+#include <sys/sendfile.h>  // sendfile
+#include <sys/stat.h>      // stat, mkdir, utimensat
+#include <unistd.h>        // copy_file_range, write, fdatasync, close, unlink
+#include <vector>
+
+#include "content_hasher.h"  // 键的SHA-256
+
+namespace {
+
+const char* META_MAGIC = "minio-object-cache 1";
+const char* LOCK_NAME = ".lock";
+
+// 下载中断留下的.part文件（及写了一半的临时元数据）超过一天没有更新就清理
+const time_t STALE_PART_SECONDS = 24 * 3600;
+// 没有元数据引用的数据文件可能是另一个进程刚rename、还没来得及写元数据的，给10分钟宽限
+const time_t ORPHAN_GRACE_SECONDS = 600;
+
+bool EndsWith(const std::string& name, const std::string& suffix) {
+    return name.size() >= suffix.size() &&
+           name.compare(name.size() - suffix.size(), suffix.size(), suffix) == 0;
+}
+
+// 打开锁文件并加排他flock，析构时关闭文件释放锁
+class FileLock {
+public:
+    FileLock() = default;
+    ~FileLock() { Release(); }
+
+    FileLock(const FileLock&) = delete;
+    FileLock& operator=(const FileLock&) = delete;
+
+    // 锁已被其他请求者持有时waited为true，并阻塞等待
+    bool Acquire(const std::string& path, bool& waited, std::string& error) {
+        fd_ = ::open(path.c_str(), O_RDWR | O_CREAT | O_CLOEXEC, 0644);
+        if (fd_ < 0) {
+            error = "无法打开锁文件 " + path + ": " + std::strerror(errno);
+            return false;
+        }
+        waited = false;
+        if (::flock(fd_, LOCK_EX | LOCK_NB) == 0) {
+            return true;
+        }
+        waited = true;
+        while (::flock(fd_, LOCK_EX) != 0) {
+            if (errno != EINTR) {
+                error = "无法锁定 " + path + ": " + std::strerror(errno);
+                return false;
+            }
+        }
+        return true;
+    }
+
+    void Release() {
+        if (fd_ >= 0) {
+            ::close(fd_);
+            fd_ = -1;
+        }
+    }
+
+private:
+    int fd_ = -1;
+};
+
+}  // namespace
+
+ObjectCache::ObjectCache(MinioConnection& connection, std::string dir, uint64_t maxBytes)
+    : connection_(connection),
+      dir_(std::move(dir)),
+      maxBytes_(maxBytes),
+      retryBudget_(DEFAULT_RETRY_BUDGET) {}
+
+bool ObjectCache::Open(std::string& error) {
+    if (::mkdir(dir_.c_str(), 0755) != 0 && errno != EEXIST) {
+        error = "无法创建缓存目录 " + dir_ + ": " + std::strerror(errno);
+        return false;
+    }
+    return true;
+}
+
+std::string ObjectCache::DataName(const std::string& key, const std::string& etag) const {
+    // ETag可能带引号等不适合做文件名的字符，取其摘要的前16个十六进制字符
+    ContentHasher hasher;
+    hasher.Update(etag.data(), etag.size());
+    return key + "-" + hasher.FinalHex().substr(0, 16) + ".data";
+}
+
+bool ObjectCache::Get(const std::string& bucket, const std::string& object,
+                      const std::string& destPath, const Fetcher& fetch, Result& result,
+                      std::string& error) {
+    result = Result();
+    ContentHasher hasher;
+    std::string name = bucket + "\n" + object;
+    hasher.Update(name.data(), name.size());
+    std::string key = hasher.FinalHex();
+    std::string metaPath = PathOf(key + ".meta");
+
+    // 单飞：同一对象同时只有一个请求者访问服务端，其他请求者在这里等待
+    int64_t requestTime = static_cast<int64_t>(std::time(nullptr));
+    FileLock keyLock;
+    if (!keyLock.Acquire(PathOf(key + ".lock"), result.coalesced, error)) {
+        return false;
+    }
+
+    Entry entry;
+    int dataFd = -1;
+    if (LoadEntry(metaPath, entry) && entry.bucket == bucket && entry.object == object) {
+        dataFd = ::open(PathOf(DataName(key, entry.etag)).c_str(), O_RDONLY | O_CLOEXEC);
+        struct stat st;
+        if (dataFd >= 0 &&
+            (::fstat(dataFd, &st) != 0 || static_cast<uint64_t>(st.st_size) != entry.size)) {
+            ::close(dataFd);  // 数据文件被截断或替换，按未命中处理
+            dataFd = -1;
+        }
+    }
+
+    if (dataFd >= 0) {
+        int64_t now = static_cast<int64_t>(std::time(nullptr));
+        // 等待期间其他请求者刚确认过的条目同样视为新鲜，不再重复验证
+        bool fresh = now - entry.validated < static_cast<int64_t>(freshSeconds_) ||
+                     (result.coalesced && entry.validated >= requestTime);
+        bool unchanged = fresh;
+        if (!fresh && !Revalidate(entry, unchanged, error)) {
+            ::close(dataFd);
+            return false;
+        }
+        if (fresh) {
+            result.source = Source::kFresh;
+            ::utimensat(AT_FDCWD, metaPath.c_str(), nullptr, 0);  // 刷新LRU时间
+        } else if (unchanged) {
+            result.source = Source::kRevalidated;
+            entry.validated = now;
+            StoreEntry(key, entry, error);  // 写失败只影响下次是否需要验证
+            error.clear();
+        } else {
+            ::close(dataFd);
+            dataFd = -1;
+        }
+    }
+
+    std::string previousData = entry.etag.empty() ? "" : DataName(key, entry.etag);
+    if (dataFd < 0) {
+        // 未命中：下载到.part，完成后rename为数据文件
+        std::string partPath = PathOf(key + ".part");
+        std::string etag;
+        uint64_t size = 0;
+        if (!fetch(partPath, etag, size, error)) {
+            return false;  // 保留.part，Fetcher可以借助续传日志继续
+        }
+        result.source = Source::kDownloaded;
+        entry.bucket = bucket;
+        entry.object = object;
+        entry.etag = etag;
+        entry.size = size;
+        entry.validated = static_cast<int64_t>(std::time(nullptr));
+
+        std::string dataPath = PathOf(DataName(key, etag));
+        result.cached = size <= maxBytes_;
+        if (!result.cached) {
+            dataPath = partPath;  // 超过缓存上限：拷出后删除
+        } else if (::rename(partPath.c_str(), dataPath.c_str()) != 0) {
+            error = "无法写入缓存 " + dataPath + ": " + std::strerror(errno);
+            return false;
+        }
+        dataFd = ::open(dataPath.c_str(), O_RDONLY | O_CLOEXEC);
+        if (dataFd < 0) {
+            error = "无法打开缓存文件 " + dataPath + ": " + std::strerror(errno);
+            return false;
+        }
+        if (!result.cached) {
+            ::unlink(dataPath.c_str());
+        } else {
+            if (!StoreEntry(key, entry, error)) {
+                ::close(dataFd);
+                return false;
+            }
+            if (!previousData.empty() && previousData != DataName(key, etag)) {
+                ::unlink(PathOf(previousData).c_str());  // 旧版本不会再被引用
+            }
+        }
+    }
+    result.size = entry.size;
+    result.etag = entry.etag;
+
+    // 已持有数据文件的描述符，之后即使被淘汰、删除也能读完，拷贝时不必占着锁
+    keyLock.Release();
+    bool ok = CopyFile(dataFd, entry.size, destPath, error);
+    ::close(dataFd);
+    if (result.source == Source::kDownloaded && result.cached) {
+        result.evicted = Evict(key);
+    }
+    return ok;
+}
+
+bool ObjectCache::Revalidate(const Entry& entry, bool& unchanged, std::string& error) {
+    // 只请求第一个字节：对象未变化时服务端返回304，变化了也只多传一个字节
+    size_t offset = 0;
+    size_t length = 1;
+    minio::s3::GetObjectArgs args;
+    args.bucket = entry.bucket;
+    args.object = entry.object;
+    if (entry.size > 0) {
+        args.offset = &offset;
+        args.length = &length;
+    }
+    args.not_match_etag = entry.etag;
+    args.datafunc = [](minio::http::DataFunctionArgs) -> bool { return true; };
+
+    minio::s3::GetObjectResponse resp;
+    if (RetryCall(retryPolicy_, retryBudget_, entry.object, [&] {
+            return connection_.Client().GetObject(args);
+        }, resp, error)) {
+        unchanged = false;
+        return true;
+    }
+    if (resp.status_code == 304) {
+        unchanged = true;
+        error.clear();
+        return true;
+    }
+    if (resp.code == "NoSuchKey") {
+        unchanged = false;  // 对象已删除：交给Fetcher报告错误
+        error.clear();
+        return true;
+    }
+    error = "验证缓存失败: " + error;
+    return false;
+}
+
+bool ObjectCache::LoadEntry(const std::string& path, Entry& entry) {
+    std::ifstream in(path);
+    std::string line;
+    if (!in.is_open() || !std::getline(in, line) || line != META_MAGIC) {
+        return false;
+    }
+    entry = Entry();
+    bool haveSize = false;
+    while (std::getline(in, line)) {
+        size_t space = line.find(' ');
+        if (space == std::string::npos) {
+            continue;
+        }
+        std::string field = line.substr(0, space);
+        std::string value = line.substr(space + 1);
+        try {
+            if (field == "bucket") {
+                entry.bucket = value;
+            } else if (field == "object") {
+                entry.object = value;
+            } else if (field == "etag") {
+                entry.etag = value;
+            } else if (field == "size") {
+                entry.size = std::stoull(value);
+                haveSize = true;
+            } else if (field == "validated") {
+                entry.validated = std::stoll(value);
+            }
+        } catch (const std::exception&) {
+            return false;
+        }
+    }
+    return haveSize && !entry.bucket.empty() && !entry.object.empty() && !entry.etag.empty();
+}
+
+bool ObjectCache::StoreEntry(const std::string& key, const Entry& entry, std::string& error) {
+    std::ostringstream text;
+    text << META_MAGIC << "\n"
+         << "bucket " << entry.bucket << "\n"
+         << "object " << entry.object << "\n"
+         << "etag " << entry.etag << "\n"
+         << "size " << entry.size << "\n"
+         << "validated " << entry.validated << "\n";
+    std::string content = text.str();
+
+    // 写临时文件后rename，读者看到的元数据要么是旧的、要么是完整的新内容
+    std::string path = PathOf(key + ".meta");
+    std::string tmpPath = path + ".tmp";
+    int fd = ::open(tmpPath.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+    if (fd < 0) {
+        error = "无法写入缓存元数据 " + tmpPath + ": " + std::strerror(errno);
+        return false;
+    }
+    size_t written = 0;
+    while (written < content.size()) {
+        ssize_t n = ::write(fd, content.data() + written, content.size() - written);
+        if (n < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            break;
+        }
+        written += static_cast<size_t>(n);
+    }
+    bool ok = written == content.size() && ::fdatasync(fd) == 0;
+    ::close(fd);
+    if (!ok || ::rename(tmpPath.c_str(), path.c_str()) != 0) {
+        error = "无法写入缓存元数据 " + path + ": " + std::strerror(errno);
+        ::unlink(tmpPath.c_str());
+        return false;
+    }
+    return true;
+}
+
+size_t ObjectCache::Evict(const std::string& keep) {
+    // 多个进程共享缓存目录，同时只有一个进程扫描和淘汰
+    FileLock lock;
+    bool waited;
+    std::string error;
+    if (!lock.Acquire(PathOf(LOCK_NAME), waited, error)) {
+        return 0;
+    }
+    DIR* dir = ::opendir(dir_.c_str());
+    if (dir == nullptr) {
+        return 0;
+    }
+
+    struct MetaFile {
+        std::string key;
+        time_t lastUsed;
+        std::string dataName;
+        uint64_t size;
+    };
+    std::vector<MetaFile> metas;
+    std::map<std::string, struct stat> dataFiles;
+    time_t now = std::time(nullptr);
+    while (dirent* item = ::readdir(dir)) {
+        std::string name = item->d_name;
+        struct stat st;
+        if (name[0] == '.' || ::stat(PathOf(name).c_str(), &st) != 0) {
+            continue;
+        }
+        if (EndsWith(name, ".meta")) {
+            std::string key = name.substr(0, name.size() - 5);
+            Entry entry;
+            if (LoadEntry(PathOf(name), entry)) {
+                metas.push_back({key, st.st_mtime, DataName(key, entry.etag), entry.size});
+            }
+        } else if (EndsWith(name, ".data")) {
+            dataFiles[name] = st;
+        } else if ((name.find(".part") != std::string::npos || EndsWith(name, ".tmp")) &&
+                   now - st.st_mtime > STALE_PART_SECONDS) {
+            ::unlink(PathOf(name).c_str());
+        }
+    }
+    ::closedir(dir);
+
+    // 统计元数据引用的数据文件；没有引用的数据文件过了宽限期后删除
+    uint64_t total = 0;
+    std::vector<MetaFile> live;
+    for (MetaFile& meta : metas) {
+        auto it = dataFiles.find(meta.dataName);
+        if (it == dataFiles.end()) {
+            continue;
+        }
+        meta.size = static_cast<uint64_t>(it->second.st_size);
+        total += meta.size;
+        live.push_back(meta);
+        dataFiles.erase(it);
+    }
+    for (const auto& orphan : dataFiles) {
+        if (now - orphan.second.st_mtime > ORPHAN_GRACE_SECONDS) {
+            ::unlink(PathOf(orphan.first).c_str());
+        } else {
+            total += static_cast<uint64_t>(orphan.second.st_size);
+        }
+    }
+
+    std::sort(live.begin(), live.end(),
+              [](const MetaFile& a, const MetaFile& b) { return a.lastUsed < b.lastUsed; });
+    size_t evicted = 0;
+    for (const MetaFile& meta : live) {
+        if (total <= maxBytes_) {
+            break;
+        }
+        if (meta.key == keep) {
+            continue;
+        }
+        // 先删元数据：其他进程不会再找到这个条目，已打开数据文件的读者不受影响
+        ::unlink(PathOf(meta.key + ".meta").c_str());
+        ::unlink(PathOf(meta.dataName).c_str());
+        total -= meta.size;
+        evicted++;
+    }
+    return evicted;
+}
+
+bool ObjectCache::CopyFile(int srcFd, uint64_t size, const std::string& destPath,
+                           std::string& error) {
+    int outFd = ::open(destPath.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+    if (outFd < 0) {
+        error = "无法创建输出文件 " + destPath + ": " + std::strerror(errno);
+        return false;
+    }
+
+    const size_t MAX_CHUNK = 1024 * 1024 * 1024;  // 单次调用最多1GB，sendfile的上限约为2GB
+    loff_t inOffset = 0;
+    bool useSendfile = false;
+    uint64_t copied = 0;
+    while (copied < size) {
+        size_t chunk = static_cast<size_t>(std::min<uint64_t>(size - copied, MAX_CHUNK));
+        ssize_t n;
+        if (!useSendfile) {
+            n = ::copy_file_range(srcFd, &inOffset, outFd, nullptr, chunk, 0);
+            if (n < 0 && copied == 0 &&
+                (errno == EXDEV || errno == EINVAL || errno == ENOSYS || errno == EOPNOTSUPP)) {
+                useSendfile = true;  // 旧内核不支持跨文件系统拷贝
+                continue;
+            }
+        } else {
+            off_t offset = static_cast<off_t>(copied);
+            n = ::sendfile(outFd, srcFd, &offset, chunk);
+        }
+        if (n < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            error = "拷贝缓存数据失败: " + std::string(std::strerror(errno));
+            break;
+        }
+        if (n == 0) {
+            error = "缓存文件比记录的大小短";
+            break;
+        }
+        copied += static_cast<size_t>(n);
+    }
+    if (::close(outFd) != 0 && error.empty()) {
+        error = "写入输出文件失败 " + destPath + ": " + std::strerror(errno);
+    }
+    if (copied < size || !error.empty()) {
+        ::unlink(destPath.c_str());
+        return false;
+    }
+    return true;
+}
@@ -0,0 +1,105 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <string>
+
+#include "minio_connection.h"
+#include "retry_policy.h"
+
+/**
+ * 本地磁盘对象缓存
+ *
+ * 功能说明：
+ * 1. 缓存条目以 存储桶+对象名 的SHA-256为键，数据文件名中带ETag的摘要，同一对象的新旧版本
+ *    不会互相覆盖；元数据文件记录ETag、大小和上次向服务端确认的时间
+ * 2. 命中后在--fresh时间内直接使用；超过后带If-None-Match请求对象的第一个字节重新验证，
+ *    服务端返回304时只刷新确认时间，不传输数据；对象已变化时重新下载
+ * 3. 多个进程、多个线程同时请求同一对象时，按键对锁文件加flock：只有一个请求者下载或验证，
+ *    其余等它完成后直接使用刚确认过的条目
+ * 4. 命中的数据用copy_file_range（XFS/btrfs上可能直接共享extent）拷到输出文件，
+ *    内核不支持跨文件系统拷贝时退回sendfile，数据不经过用户态
+ * 5. 新条目写入后按元数据文件的修改时间（每次使用时刷新）做LRU淘汰，总大小不超过上限；
+ *    大于上限的对象不缓存
+ *
+ * 目录结构：
+ *   <键>.meta                 元数据（文本，写临时文件后rename替换）
+ *   <键>-<ETag摘要>.data      对象数据
+ *   <键>.part                 下载中的数据（进程崩溃后保留，可配合续传日志继续）
+ *   <键>.lock                 单飞锁文件（只用于flock，长期保留）
+ *   .lock                     淘汰扫描锁
+ *
+ * 未命中时由调用方提供的Fetcher把对象下载到指定路径（例如RangeDownloader并发分段下载），
+ * 缓存本身只负责查找、验证、提交和淘汰。一个ObjectCache对象只能由一个线程使用。
+ */
+class ObjectCache {
+public:
+    enum class Source {
+        kFresh,        // 在新鲜期内，没有访问服务端
+        kRevalidated,  // 服务端返回304，没有传输数据
+        kDownloaded,   // 未命中或对象已变化，重新下载
+    };
+
+    struct Result {
+        Source source = Source::kDownloaded;
+        uint64_t size = 0;
+        std::string etag;
+        bool coalesced = false;  // 等待了同时在下载或验证同一对象的其他请求者
+        bool cached = true;      // 对象超过缓存上限时为false，只下载不缓存
+        size_t evicted = 0;      // 本次淘汰的条目数
+    };
+
+    // 把对象下载到path，返回对象的ETag和大小
+    using Fetcher = std::function<bool(const std::string& path, std::string& etag,
+                                       uint64_t& size, std::string& error)>;
+
+    static constexpr uint64_t DEFAULT_MAX_BYTES = 10ULL * 1024 * 1024 * 1024;  // 默认10GB
+    static constexpr size_t DEFAULT_RETRY_BUDGET = 20;  // 验证请求的重试预算
+
+    ObjectCache(MinioConnection& connection, std::string dir, uint64_t maxBytes);
+
+    ObjectCache(const ObjectCache&) = delete;
+    ObjectCache& operator=(const ObjectCache&) = delete;
+
+    // 上次确认后多少秒内不再向服务端验证，默认0表示每次使用都验证
+    void SetFreshSeconds(unsigned int seconds) { freshSeconds_ = seconds; }
+
+    // 创建缓存目录（不存在时）
+    bool Open(std::string& error);
+
+    // 把bucket/object写到destPath：命中时从缓存拷贝，未命中时调用fetch下载后放入缓存
+    bool Get(const std::string& bucket, const std::string& object, const std::string& destPath,
+             const Fetcher& fetch, Result& result, std::string& error);
+
+    // 用copy_file_range（必要时退回sendfile）把srcFd的前size字节拷到destPath
+    static bool CopyFile(int srcFd, uint64_t size, const std::string& destPath, std::string& error);
+
+private:
+    struct Entry {
+        std::string bucket;
+        std::string object;
+        std::string etag;
+        uint64_t size = 0;
+        int64_t validated = 0;  // 上次向服务端确认的时间（Unix秒）
+    };
+
+    std::string PathOf(const std::string& name) const { return dir_ + "/" + name; }
+    std::string DataName(const std::string& key, const std::string& etag) const;
+
+    static bool LoadEntry(const std::string& path, Entry& entry);
+    bool StoreEntry(const std::string& key, const Entry& entry, std::string& error);
+
+    // 带If-None-Match请求对象：未变化返回true并置unchanged；对象已变化时unchanged为false
+    bool Revalidate(const Entry& entry, bool& unchanged, std::string& error);
+
+    // 淘汰最久未使用的条目直到总大小不超过上限，keep为刚写入的键，不参与淘汰
+    size_t Evict(const std::string& keep);
+
+    MinioConnection& connection_;
+    const std::string dir_;
+    const uint64_t maxBytes_;
+    unsigned int freshSeconds_ = 0;
+    RetryPolicy retryPolicy_;
+    RetryBudget retryBudget_;
+};
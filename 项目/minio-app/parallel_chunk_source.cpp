@@ -0,0 +1,122 @@
+#include "parallel_chunk_source.h"
+
+#include <algorithm>
+#include <cstring>
+
+ParallelChunkSource::ParallelChunkSource(SequentialSource& source, std::string name,
+                                         size_t threads, size_t chunkSize, size_t outputCapacity,
+                                         bool requireLastChunk)
+    : source_(source),
+      chunkSize_(chunkSize),
+      outputCapacity_(outputCapacity),
+      requireLastChunk_(requireLastChunk),
+      name_(std::move(name)) {
+    if (threads == 0) {
+        threads = 1;
+    }
+    // 线程数两倍的槽位：调用方取走一个块的输出时，其余线程仍有块可处理
+    for (size_t i = 0; i < threads * 2; ++i) {
+        auto slot = std::make_unique<Slot>();
+        slot->input = std::make_unique<PartBuffer>(chunkSize_);
+        slot->output = std::make_unique<PartBuffer>(outputCapacity_);
+        slots_.push_back(std::move(slot));
+    }
+    pool_ = std::make_unique<ThreadPool>(threads, slots_.size());
+}
+
+ParallelChunkSource::~ParallelChunkSource() {
+    pool_->Wait();
+}
+
+void ParallelChunkSource::Submit(Slot& slot, size_t inputSize, bool isLast) {
+    slot.index = submitted_;
+    slot.isLast = isLast;
+    slot.inputSize = inputSize;
+    slot.outputOffset = 0;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        slot.done = false;
+    }
+    pool_->Submit([this, &slot](size_t workerIndex) { Transform(workerIndex, slot); });
+    submitted_++;
+    lastSubmitted_ = isLast;
+}
+
+bool ParallelChunkSource::FillSlots() {
+    while (!sourceEof_ && submitted_ - drained_ < slots_.size()) {
+        Slot& slot = *slots_[submitted_ % slots_.size()];
+        size_t bytesRead = 0;
+        if (!source_.ReadFull(slot.input->Data(), chunkSize_, bytesRead)) {
+            lastError_ = source_.LastError();
+            return false;
+        }
+        sourceEof_ = source_.Eof();
+        if (bytesRead > 0) {
+            Submit(slot, bytesRead, sourceEof_);
+        } else if (requireLastChunk_ && !lastSubmitted_) {
+            // 上一块读满时还不知道输入已结束，补一个空的最后块
+            Submit(slot, 0, true);
+        }
+    }
+    return true;
+}
+
+void ParallelChunkSource::Transform(size_t workerIndex, Slot& slot) {
+    size_t outputSize = 0;
+    std::string error;
+    if (!TransformChunk(workerIndex, slot.index, slot.isLast, slot.input->Data(), slot.inputSize,
+                        slot.output->Data(), outputSize, error)) {
+        outputSize = 0;
+        if (error.empty()) {
+            error = "处理第" + std::to_string(slot.index) + "块失败";
+        }
+    }
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        slot.outputSize = outputSize;
+        slot.error = std::move(error);
+        slot.done = true;
+    }
+    slotDone_.notify_all();
+}
+
+bool ParallelChunkSource::ReadFull(char* dest, size_t length, size_t& bytesRead) {
+    bytesRead = 0;
+    if (prefixOffset_ < prefix_.size()) {
+        size_t n = std::min(length, prefix_.size() - prefixOffset_);
+        std::memcpy(dest, prefix_.data() + prefixOffset_, n);
+        prefixOffset_ += n;
+        bytesRead += n;
+        bytesOut_ += n;
+    }
+    while (bytesRead < length) {
+        if (!FillSlots()) {
+            return false;
+        }
+        if (drained_ == submitted_) {
+            break;  // 原始输入已读完，所有块都已取完
+        }
+
+        // 按提交顺序取输出，保证输出顺序与原始数据一致
+        Slot& slot = *slots_[drained_ % slots_.size()];
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            slotDone_.wait(lock, [&slot] { return slot.done; });
+        }
+        if (!slot.error.empty()) {
+            lastError_ = slot.error;
+            return false;
+        }
+        size_t n = std::min(length - bytesRead, slot.outputSize - slot.outputOffset);
+        std::memcpy(dest + bytesRead, slot.output->Data() + slot.outputOffset, n);
+        bytesRead += n;
+        slot.outputOffset += n;
+        bytesOut_ += n;
+        if (slot.outputOffset == slot.outputSize) {
+            drained_++;  // 槽位空出，下一次FillSlots复用
+        }
+    }
+    // 提前判断结束，调用方不必再多读一次空块
+    eof_ = sourceEof_ && drained_ == submitted_ && prefixOffset_ == prefix_.size();
+    return true;
+}
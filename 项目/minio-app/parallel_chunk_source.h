@@ -0,0 +1,101 @@
+#pragma once
+
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "part_buffer.h"
+#include "stream_source.h"
+#include "thread_pool.h"
+
+/**
+ * 按块并行变换的顺序数据源（压缩、加密等处理阶段的公共部分）
+ *
+ * 功能说明：
+ * 1. 叠加在任意SequentialSource之上，本身也是SequentialSource，可以层层串联
+ *    （例如 文件 -> 压缩 -> 加密 -> 上传）
+ * 2. 原始输入按固定大小切块，每块在线程池上独立变换，按输入顺序输出；
+ *    调用方消费已完成的块时，后续块在其他线程处理，读取、变换、上传三段流水线重叠
+ * 3. 槽位数为线程数的两倍，环形复用，内存占用固定；块缓冲区从BufferPool借出
+ * 4. 派生类只实现TransformChunk()；可以在所有块之前输出一段前缀（如文件头），
+ *    也可以要求总是输出一个标记为"最后"的块（输入恰好以整块结束时补一个空块）
+ */
+class ParallelChunkSource : public SequentialSource {
+public:
+    ~ParallelChunkSource() override;
+
+    ParallelChunkSource(const ParallelChunkSource&) = delete;
+    ParallelChunkSource& operator=(const ParallelChunkSource&) = delete;
+
+    bool ReadFull(char* dest, size_t length, size_t& bytesRead) override;
+
+    bool Eof() const override { return eof_; }
+    // 已输出的字节数（含前缀）
+    size_t BytesRead() const override { return bytesOut_; }
+    const std::string& Name() const override { return name_; }
+    const std::string& LastError() const override { return lastError_; }
+
+    // 已读取的原始字节数
+    size_t BytesIn() const { return source_.BytesRead(); }
+
+protected:
+    // outputCapacity: 单块输出的最大长度；requireLastChunk: 是否总是输出一个isLast块
+    ParallelChunkSource(SequentialSource& source, std::string name, size_t threads,
+                        size_t chunkSize, size_t outputCapacity, bool requireLastChunk);
+
+    // 须在第一次ReadFull()之前调用
+    void SetPrefix(std::string prefix) { prefix_ = std::move(prefix); }
+
+    // 在线程池上调用：把第index块（从0开始）变换到output，写入输出长度；
+    // isLast表示这是最后一块；同一workerIndex不会被并发调用
+    virtual bool TransformChunk(size_t workerIndex, uint64_t index, bool isLast, const char* input,
+                                size_t inputSize, char* output, size_t& outputSize,
+                                std::string& error) = 0;
+
+    size_t ThreadCount() const { return pool_->ThreadCount(); }
+
+private:
+    struct Slot {
+        std::unique_ptr<PartBuffer> input;
+        std::unique_ptr<PartBuffer> output;
+        uint64_t index = 0;
+        bool isLast = false;
+        size_t inputSize = 0;
+        size_t outputSize = 0;
+        size_t outputOffset = 0;  // 已交给调用方的输出字节数
+        bool done = false;        // 变换完成（受mutex_保护）
+        std::string error;
+    };
+
+    // 读取原始输入填满空闲槽位并提交变换
+    bool FillSlots();
+    void Submit(Slot& slot, size_t inputSize, bool isLast);
+    void Transform(size_t workerIndex, Slot& slot);
+
+    SequentialSource& source_;
+    const size_t chunkSize_;
+    const size_t outputCapacity_;
+    const bool requireLastChunk_;
+    std::string name_;
+    std::string lastError_;
+    std::string prefix_;
+    size_t prefixOffset_ = 0;
+    bool sourceEof_ = false;
+    bool lastSubmitted_ = false;
+    bool eof_ = false;
+    size_t bytesOut_ = 0;
+
+    // 槽位按环形使用：submitted_ - drained_ 个槽位在变换中或尚未取完
+    std::vector<std::unique_ptr<Slot>> slots_;
+    uint64_t submitted_ = 0;
+    uint64_t drained_ = 0;
+    std::mutex mutex_;
+    std::condition_variable slotDone_;
+
+    // 最后声明，最先析构：保证变换线程退出后才销毁槽位
+    std::unique_ptr<ThreadPool> pool_;
+};
@@ -0,0 +1,58 @@
+#pragma once
+
+#include <cstddef>
+#include <string>
+#include <string_view>
+
+#include "buffer_pool.h"
+
+/**
+ * 预分配的分块缓冲区
+ *
+ * 文件数据直接读入Data()指向的内存，再以View()的string_view形式交给UploadPart，
+ * 中间不经过vector追加和std::string转换：每个上传字节只有一次文件读取拷贝。
+ * 缓冲区在上传完成后归还复用，整个上传过程不再按分块重新分配内存。
+ *
+ * 内存从进程级BufferPool借出，析构时归还，下一个上传或下一批缓冲区直接复用；
+ * 按4KB页对齐、容量向上取整到整页，满足O_DIRECT读取对缓冲区地址和长度的对齐要求。
+ * 容量为0时不借内存（Data()为空指针），用于数据来自别处、只需要占位的场合。
+ */
+class PartBuffer {
+public:
+    static constexpr size_t ALIGNMENT = BufferPool::PAGE_SIZE;
+
+    explicit PartBuffer(size_t capacity) : capacity_(capacity) {
+        if (capacity > 0) {
+            slab_ = BufferPool::Instance().Acquire(capacity);
+        }
+    }
+
+    ~PartBuffer() {
+        if (slab_.data != nullptr) {
+            BufferPool::Instance().Release(slab_);
+        }
+    }
+
+    PartBuffer(const PartBuffer&) = delete;
+    PartBuffer& operator=(const PartBuffer&) = delete;
+
+    char* Data() { return slab_.data; }
+    const char* Data() const { return slab_.data; }
+    size_t Capacity() const { return capacity_; }
+
+    // 已填充的有效字节数
+    size_t Size() const { return size_; }
+    void SetSize(size_t size) { size_ = size; }
+
+    std::string_view View() const { return std::string_view(slab_.data, size_); }
+
+    // 暂存阶段算好的分块MD5原始字节，未计算时为空；上传和哈希直接使用，不再重复计算
+    const std::string& Md5() const { return md5_; }
+    void SetMd5(std::string md5) { md5_ = std::move(md5); }
+
+private:
+    BufferPool::Slab slab_;
+    size_t capacity_;
+    size_t size_ = 0;
+    std::string md5_;
+};
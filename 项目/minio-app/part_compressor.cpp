@@ -0,0 +1,99 @@
+#include "part_compressor.h"
+
+#ifdef MINIO_APP_HAVE_ZSTD
+#include <zstd.h>
+#endif
+
+bool PartCompressor::Available() {
+#ifdef MINIO_APP_HAVE_ZSTD
+    return true;
+#else
+    return false;
+#endif
+}
+
+size_t PartCompressor::OutputCapacity(size_t chunkSize) {
+#ifdef MINIO_APP_HAVE_ZSTD
+    return ZSTD_compressBound(chunkSize);
+#else
+    return chunkSize;
+#endif
+}
+
+PartCompressor::PartCompressor(SequentialSource& source, size_t threads, int level,
+                               size_t chunkSize)
+    : ParallelChunkSource(source, source.Name() + "（zstd压缩）", threads, chunkSize,
+                          OutputCapacity(chunkSize), false),
+      level_(level) {}
+
+bool PartCompressor::TransformChunk(size_t, uint64_t, bool, const char* input, size_t inputSize,
+                                    char* output, size_t& outputSize, std::string& error) {
+#ifdef MINIO_APP_HAVE_ZSTD
+    outputSize = ZSTD_compress(output, OutputCapacity(inputSize), input, inputSize, level_);
+    if (ZSTD_isError(outputSize)) {
+        error = std::string("zstd压缩失败: ") + ZSTD_getErrorName(outputSize);
+        return false;
+    }
+    return true;
+#else
+    (void)input;
+    (void)inputSize;
+    (void)output;
+    (void)outputSize;
+    (void)level_;
+    error = "编译时未启用zstd支持";
+    return false;
+#endif
+}
+
+StreamDecompressor::StreamDecompressor() {
+#ifdef MINIO_APP_HAVE_ZSTD
+    stream_ = ZSTD_createDStream();
+    ZSTD_initDStream(stream_);
+    outputCapacity_ = ZSTD_DStreamOutSize();
+    output_.reset(new char[outputCapacity_]);
+#endif
+}
+
+StreamDecompressor::~StreamDecompressor() {
+#ifdef MINIO_APP_HAVE_ZSTD
+    ZSTD_freeDStream(stream_);
+#endif
+}
+
+bool StreamDecompressor::Write(const char* data, size_t size, const Sink& sink, std::string& error) {
+#ifdef MINIO_APP_HAVE_ZSTD
+    ZSTD_inBuffer input = {data, size, 0};
+    // 输出缓冲区被写满时解压器内部可能还有数据，输入耗尽后也要继续调用
+    bool outputFull = true;
+    while (input.pos < input.size || outputFull) {
+        ZSTD_outBuffer output = {output_.get(), outputCapacity_, 0};
+        size_t ret = ZSTD_decompressStream(stream_, &output, &input);
+        if (ZSTD_isError(ret)) {
+            error = std::string("zstd解压失败: ") + ZSTD_getErrorName(ret);
+            return false;
+        }
+        frameRemaining_ = ret;
+        outputFull = output.pos == output.size;
+        if (output.pos > 0 && !sink(output_.get(), output.pos)) {
+            error = "写出解压数据失败";
+            return false;
+        }
+    }
+    return true;
+#else
+    (void)data;
+    (void)size;
+    (void)sink;
+    error = "编译时未启用zstd支持，无法解压";
+    return false;
+#endif
+}
+
+bool StreamDecompressor::Finish(std::string& error) const {
+    if (frameRemaining_ != 0) {
+        error = "压缩数据不完整，对象可能被截断";
+        return false;
+    }
+    return true;
+}
@@ -0,0 +1,73 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <string>
+
+#include "parallel_chunk_source.h"
+
+/**
+ * 上传前的并行zstd压缩，以及下载时的流式解压
+ *
+ * 功能说明：
+ * 1. PartCompressor是ParallelChunkSource：原始输入按固定大小切块，
+ *    每块在线程池上独立压缩成一个zstd帧，按输入顺序输出
+ * 2. 多个zstd帧首尾相接仍是合法的zstd流，下载端流式解压即可还原，不需要额外索引；
+ *    帧可以跨越上传分块的边界，上传方照常把缓冲区读满再提交，压缩后每个分块仍不小于5MB
+ * 3. 压缩对象带用户元数据 content-codec: zstd，下载方据此决定是否解压
+ * 4. StreamDecompressor在GetObject的datafunc中逐块解压，内存占用与对象大小无关
+ *
+ * 编译时未找到libzstd（未定义MINIO_APP_HAVE_ZSTD）时Available()返回false。
+ */
+struct ZSTD_DCtx_s;  // zstd.h中的ZSTD_DStream，避免在头文件中引入zstd.h
+
+class PartCompressor : public ParallelChunkSource {
+public:
+    static constexpr size_t DEFAULT_CHUNK_SIZE = 4 * 1024 * 1024;  // 每个zstd帧的原始数据量
+    static constexpr int DEFAULT_LEVEL = 3;
+    // 用户元数据键（不含x-amz-meta-前缀）和取值
+    static constexpr const char* CODEC_METADATA_KEY = "content-codec";
+    static constexpr const char* CODEC_ZSTD = "zstd";
+
+    // 编译时是否带有zstd支持
+    static bool Available();
+
+    // threads: 压缩线程数
+    PartCompressor(SequentialSource& source, size_t threads, int level,
+                   size_t chunkSize = DEFAULT_CHUNK_SIZE);
+
+protected:
+    bool TransformChunk(size_t workerIndex, uint64_t index, bool isLast, const char* input,
+                        size_t inputSize, char* output, size_t& outputSize,
+                        std::string& error) override;
+
+private:
+    static size_t OutputCapacity(size_t chunkSize);
+
+    const int level_;
+};
+
+class StreamDecompressor {
+public:
+    // 解压得到的数据依次交给sink；sink返回false时停止
+    using Sink = std::function<bool(const char* data, size_t size)>;
+
+    StreamDecompressor();
+    ~StreamDecompressor();
+
+    StreamDecompressor(const StreamDecompressor&) = delete;
+    StreamDecompressor& operator=(const StreamDecompressor&) = delete;
+
+    // 送入一段压缩数据，可在任意位置切分；出错返回false并写入error
+    bool Write(const char* data, size_t size, const Sink& sink, std::string& error);
+    // 所有数据送入后调用：最后一个帧不完整（对象被截断）时返回false
+    bool Finish(std::string& error) const;
+
+private:
+    ZSTD_DCtx_s* stream_ = nullptr;
+    size_t frameRemaining_ = 0;  // 上一次解压调用的返回值，0表示正好位于帧边界
+    std::unique_ptr<char[]> output_;
+    size_t outputCapacity_ = 0;
+};
@@ -0,0 +1,246 @@
+#include "part_encryptor.h"
+
+#include <algorithm>
+#include <cctype>
+#include <climits>
+#include <fstream>
+#include <iterator>
+#include <openssl/evp.h>
+#include <openssl/hmac.h>
+#include <openssl/rand.h>
+
+#include "content_hasher.h"  // FromHex
+
+namespace {
+
+const char MAGIC[4] = {'M', 'C', 'E', '1'};
+const size_t NONCE_SIZE = 12;
+const size_t MAX_RECORD_SIZE = 64 * 1024 * 1024;  // 解析对象头时拒绝异常的记录长度
+
+// nonce = 4字节0 + 8字节大端记录序号
+void MakeNonce(uint64_t index, unsigned char* nonce) {
+    std::fill(nonce, nonce + NONCE_SIZE, 0);
+    for (int i = 0; i < 8; ++i) {
+        nonce[NONCE_SIZE - 1 - i] = static_cast<unsigned char>(index >> (8 * i));
+    }
+}
+
+}  // namespace
+
+// ==================== ObjectCipher ====================
+
+bool ObjectCipher::LoadKey(const std::string& path, std::string& key, std::string& error) {
+    std::ifstream file(path, std::ios::binary);
+    if (!file.is_open()) {
+        error = "无法打开密钥文件: " + path;
+        return false;
+    }
+    std::string content((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+    if (content.size() == KEY_SIZE) {
+        key = content;
+        return true;
+    }
+    while (!content.empty() && std::isspace(static_cast<unsigned char>(content.back()))) {
+        content.pop_back();
+    }
+    if (content.size() == KEY_SIZE * 2) {
+        key = ContentHasher::FromHex(content);
+        if (key.size() == KEY_SIZE) {
+            return true;
+        }
+    }
+    error = "密钥文件须为32字节原始数据或64个十六进制字符: " + path;
+    return false;
+}
+
+bool ObjectCipher::DeriveKey(const std::string& masterKey, std::string& error) {
+    unsigned char digest[EVP_MAX_MD_SIZE];
+    unsigned int digestLength = 0;
+    if (HMAC(EVP_sha256(), masterKey.data(), static_cast<int>(masterKey.size()),
+             reinterpret_cast<const unsigned char*>(salt_.data()), salt_.size(), digest,
+             &digestLength) == nullptr ||
+        digestLength != KEY_SIZE) {
+        error = "派生数据密钥失败";
+        return false;
+    }
+    dataKey_.assign(reinterpret_cast<const char*>(digest), digestLength);
+    return true;
+}
+
+bool ObjectCipher::InitNew(const std::string& masterKey, size_t recordSize, std::string& error) {
+    recordSize_ = recordSize;
+    salt_.resize(SALT_SIZE);
+    if (RAND_bytes(reinterpret_cast<unsigned char*>(&salt_[0]), SALT_SIZE) != 1) {
+        error = "生成随机盐失败";
+        return false;
+    }
+    return DeriveKey(masterKey, error);
+}
+
+bool ObjectCipher::InitFromHeader(const std::string& masterKey, const char* header,
+                                  std::string& error) {
+    if (!std::equal(MAGIC, MAGIC + sizeof(MAGIC), header)) {
+        error = "不是客户端加密的对象（文件头不匹配）";
+        return false;
+    }
+    const unsigned char* size = reinterpret_cast<const unsigned char*>(header + sizeof(MAGIC));
+    recordSize_ =
+        (size_t(size[0]) << 24) | (size_t(size[1]) << 16) | (size_t(size[2]) << 8) | size[3];
+    if (recordSize_ == 0 || recordSize_ > MAX_RECORD_SIZE) {
+        error = "加密对象头中的记录长度无效";
+        return false;
+    }
+    salt_.assign(header + sizeof(MAGIC) + 4, SALT_SIZE);
+    return DeriveKey(masterKey, error);
+}
+
+std::string ObjectCipher::Header() const {
+    std::string header(MAGIC, sizeof(MAGIC));
+    for (int shift = 24; shift >= 0; shift -= 8) {
+        header.push_back(static_cast<char>(recordSize_ >> shift));
+    }
+    header += salt_;
+    return header;
+}
+
+// ==================== RecordCipher ====================
+
+RecordCipher::RecordCipher(const ObjectCipher& cipher, bool encrypt)
+    : ctx_(EVP_CIPHER_CTX_new()) {
+    // 密钥只设置一次，之后每条记录只更换nonce，不重复展开密钥
+    const unsigned char* key = reinterpret_cast<const unsigned char*>(cipher.DataKey().data());
+    if (encrypt) {
+        EVP_EncryptInit_ex(ctx_, EVP_aes_256_gcm(), nullptr, key, nullptr);
+    } else {
+        EVP_DecryptInit_ex(ctx_, EVP_aes_256_gcm(), nullptr, key, nullptr);
+    }
+}
+
+RecordCipher::~RecordCipher() {
+    EVP_CIPHER_CTX_free(ctx_);
+}
+
+bool RecordCipher::Seal(uint64_t index, bool isLast, const char* input, size_t inputSize,
+                        char* output, std::string& error) {
+    unsigned char nonce[NONCE_SIZE];
+    MakeNonce(index, nonce);
+    unsigned char aad = isLast ? 1 : 0;
+    unsigned char* out = reinterpret_cast<unsigned char*>(output);
+    int length = 0;
+    int finalLength = 0;
+    bool ok = inputSize <= INT_MAX &&
+              EVP_EncryptInit_ex(ctx_, nullptr, nullptr, nullptr, nonce) == 1 &&
+              EVP_EncryptUpdate(ctx_, nullptr, &length, &aad, 1) == 1 &&
+              (inputSize == 0 ||
+               EVP_EncryptUpdate(ctx_, out, &length, reinterpret_cast<const unsigned char*>(input),
+                                 static_cast<int>(inputSize)) == 1) &&
+              EVP_EncryptFinal_ex(ctx_, out + inputSize, &finalLength) == 1 &&
+              EVP_CIPHER_CTX_ctrl(ctx_, EVP_CTRL_GCM_GET_TAG, ObjectCipher::TAG_SIZE,
+                                  out + inputSize) == 1;
+    if (!ok) {
+        error = "加密第" + std::to_string(index) + "条记录失败";
+    }
+    return ok;
+}
+
+bool RecordCipher::Open(uint64_t index, bool isLast, const char* input, size_t inputSize,
+                        char* output, std::string& error) {
+    if (inputSize < ObjectCipher::TAG_SIZE) {
+        error = "第" + std::to_string(index) + "条记录不完整";
+        return false;
+    }
+    size_t cipherSize = inputSize - ObjectCipher::TAG_SIZE;
+    unsigned char nonce[NONCE_SIZE];
+    MakeNonce(index, nonce);
+    unsigned char aad = isLast ? 1 : 0;
+    unsigned char* out = reinterpret_cast<unsigned char*>(output);
+    // SET_TAG的参数不是const，复制一份标签
+    unsigned char tag[ObjectCipher::TAG_SIZE];
+    std::copy(input + cipherSize, input + inputSize, tag);
+    int length = 0;
+    int finalLength = 0;
+    bool ok = cipherSize <= INT_MAX &&
+              EVP_DecryptInit_ex(ctx_, nullptr, nullptr, nullptr, nonce) == 1 &&
+              EVP_DecryptUpdate(ctx_, nullptr, &length, &aad, 1) == 1 &&
+              (cipherSize == 0 ||
+               EVP_DecryptUpdate(ctx_, out, &length, reinterpret_cast<const unsigned char*>(input),
+                                 static_cast<int>(cipherSize)) == 1) &&
+              EVP_CIPHER_CTX_ctrl(ctx_, EVP_CTRL_GCM_SET_TAG, ObjectCipher::TAG_SIZE, tag) == 1 &&
+              EVP_DecryptFinal_ex(ctx_, out + cipherSize, &finalLength) == 1;
+    if (!ok) {
+        error = "第" + std::to_string(index) + "条记录认证失败：密钥错误或数据被篡改、截断";
+    }
+    return ok;
+}
+
+// ==================== PartEncryptor ====================
+
+PartEncryptor::PartEncryptor(SequentialSource& source, const ObjectCipher& cipher, size_t threads)
+    : ParallelChunkSource(source, source.Name() + "（AES-256-GCM加密）", threads,
+                          cipher.RecordSize(), cipher.RecordSize() + ObjectCipher::TAG_SIZE, true) {
+    for (size_t i = 0; i < ThreadCount(); ++i) {
+        ciphers_.push_back(std::make_unique<RecordCipher>(cipher, true));
+    }
+    SetPrefix(cipher.Header());
+}
+
+bool PartEncryptor::TransformChunk(size_t workerIndex, uint64_t index, bool isLast,
+                                   const char* input, size_t inputSize, char* output,
+                                   size_t& outputSize, std::string& error) {
+    outputSize = inputSize + ObjectCipher::TAG_SIZE;
+    return ciphers_[workerIndex]->Seal(index, isLast, input, inputSize, output, error);
+}
+
+// ==================== StreamDecryptor ====================
+
+bool StreamDecryptor::DecryptPending(bool isLast, const Sink& sink, std::string& error) {
+    if (!record_->Open(index_, isLast, pending_.data(), pending_.size(), plain_.get(), error)) {
+        return false;
+    }
+    size_t plainSize = pending_.size() - ObjectCipher::TAG_SIZE;
+    index_++;
+    pending_.clear();
+    if (plainSize > 0 && !sink(plain_.get(), plainSize)) {
+        error = "写出解密数据失败";
+        return false;
+    }
+    return true;
+}
+
+bool StreamDecryptor::Write(const char* data, size_t size, const Sink& sink, std::string& error) {
+    while (size > 0) {
+        if (header_.size() < ObjectCipher::HEADER_SIZE) {
+            size_t n = std::min(size, ObjectCipher::HEADER_SIZE - header_.size());
+            header_.append(data, n);
+            data += n;
+            size -= n;
+            if (header_.size() == ObjectCipher::HEADER_SIZE) {
+                if (!cipher_.InitFromHeader(masterKey_, header_.data(), error)) {
+                    return false;
+                }
+                record_ = std::make_unique<RecordCipher>(cipher_, false);
+                plain_.reset(new char[cipher_.RecordSize()]);
+                pending_.reserve(cipher_.RecordSize() + ObjectCipher::TAG_SIZE);
+            }
+            continue;
+        }
+        // 缓冲满一条记录且后面还有数据，说明它不是最后一条
+        size_t recordBytes = cipher_.RecordSize() + ObjectCipher::TAG_SIZE;
+        if (pending_.size() == recordBytes && !DecryptPending(false, sink, error)) {
+            return false;
+        }
+        size_t n = std::min(size, recordBytes - pending_.size());
+        pending_.append(data, n);
+        data += n;
+        size -= n;
+    }
+    return true;
+}
+
+bool StreamDecryptor::Finish(const Sink& sink, std::string& error) {
+    if (header_.size() < ObjectCipher::HEADER_SIZE) {
+        error = "加密对象不完整：缺少文件头";
+        return false;
+    }
+    return DecryptPending(true, sink, error);
+}
@@ -0,0 +1,119 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "parallel_chunk_source.h"
+
+typedef struct evp_cipher_ctx_st EVP_CIPHER_CTX;  // OpenSSL加密上下文，避免在头文件中引入openssl
+
+/**
+ * 客户端AES-256-GCM加密（基于OpenSSL EVP接口，自动使用AES-NI/PCLMULQDQ等硬件指令）
+ *
+ * 对象格式：
+ *   24字节头（"MCE1" + 记录明文长度(4字节大端) + 16字节随机盐） + 若干记录
+ *   每条记录 = 密文 + 16字节GCM标签；除最后一条外明文长度都等于记录长度，
+ *   第i条记录在对象中的偏移可以直接算出，各记录能够并行、乱序加解密
+ *
+ * 密钥与nonce：
+ * - 数据密钥 = HMAC-SHA256(主密钥, 盐)，每个对象的密钥不同
+ * - nonce = 4字节0 + 8字节大端记录序号，同一密钥下不会重复
+ * - 附加认证数据为1字节"是否最后一条"：记录被篡改、重排或对象被截断都无法通过认证
+ *
+ * 加密对象带用户元数据 client-encryption: aes-256-gcm；压缩与加密同时使用时先压缩后加密。
+ */
+class ObjectCipher {
+public:
+    static constexpr size_t KEY_SIZE = 32;
+    static constexpr size_t SALT_SIZE = 16;
+    static constexpr size_t TAG_SIZE = 16;
+    static constexpr size_t HEADER_SIZE = 24;
+    static constexpr size_t DEFAULT_RECORD_SIZE = 1024 * 1024;
+    // 用户元数据键（不含x-amz-meta-前缀）和取值
+    static constexpr const char* METADATA_KEY = "client-encryption";
+    static constexpr const char* ALGORITHM = "aes-256-gcm";
+
+    // 读取主密钥文件：32字节原始数据或64个十六进制字符（允许末尾换行）
+    static bool LoadKey(const std::string& path, std::string& key, std::string& error);
+
+    // 加密新对象：生成随机盐并派生数据密钥
+    bool InitNew(const std::string& masterKey, size_t recordSize, std::string& error);
+    // 解密已有对象：header为对象开头的HEADER_SIZE字节
+    bool InitFromHeader(const std::string& masterKey, const char* header, std::string& error);
+
+    // 写在对象开头的HEADER_SIZE字节
+    std::string Header() const;
+    size_t RecordSize() const { return recordSize_; }
+    const std::string& DataKey() const { return dataKey_; }
+
+private:
+    bool DeriveKey(const std::string& masterKey, std::string& error);
+
+    size_t recordSize_ = 0;
+    std::string salt_;
+    std::string dataKey_;
+};
+
+// 单条记录的加解密，持有一个已设置数据密钥的EVP上下文；只能由一个线程使用
+class RecordCipher {
+public:
+    RecordCipher(const ObjectCipher& cipher, bool encrypt);
+    ~RecordCipher();
+
+    RecordCipher(const RecordCipher&) = delete;
+    RecordCipher& operator=(const RecordCipher&) = delete;
+
+    // output须有inputSize + TAG_SIZE字节
+    bool Seal(uint64_t index, bool isLast, const char* input, size_t inputSize, char* output,
+              std::string& error);
+    // input含末尾的标签，output须有inputSize - TAG_SIZE字节；认证失败返回false
+    bool Open(uint64_t index, bool isLast, const char* input, size_t inputSize, char* output,
+              std::string& error);
+
+private:
+    EVP_CIPHER_CTX* ctx_;
+};
+
+// 上传前的并行加密阶段：每条记录是一个块，在线程池上独立加密
+class PartEncryptor : public ParallelChunkSource {
+public:
+    // cipher须已InitNew()，且比加密器存活更久
+    PartEncryptor(SequentialSource& source, const ObjectCipher& cipher, size_t threads);
+
+protected:
+    bool TransformChunk(size_t workerIndex, uint64_t index, bool isLast, const char* input,
+                        size_t inputSize, char* output, size_t& outputSize,
+                        std::string& error) override;
+
+private:
+    std::vector<std::unique_ptr<RecordCipher>> ciphers_;  // 每个线程一个
+};
+
+// 下载时在GetObject的datafunc中逐条记录解密，内存占用为一条记录
+class StreamDecryptor {
+public:
+    // 解密得到的明文依次交给sink；sink返回false时停止
+    using Sink = std::function<bool(const char* data, size_t size)>;
+
+    explicit StreamDecryptor(std::string masterKey) : masterKey_(std::move(masterKey)) {}
+
+    // 送入一段密文，可在任意位置切分；出错返回false并写入error
+    bool Write(const char* data, size_t size, const Sink& sink, std::string& error);
+    // 所有数据送入后调用：解密并认证最后一条记录，对象被截断时返回false
+    bool Finish(const Sink& sink, std::string& error);
+
+private:
+    bool DecryptPending(bool isLast, const Sink& sink, std::string& error);
+
+    const std::string masterKey_;
+    ObjectCipher cipher_;
+    std::unique_ptr<RecordCipher> record_;
+    std::string header_;
+    std::string pending_;  // 尚未解密的一条记录
+    std::unique_ptr<char[]> plain_;
+    uint64_t index_ = 0;
+};
@@ -0,0 +1,142 @@
+#include "part_hasher.h"
+
+#include <chrono>
+
+PartHasher::PartHasher(size_t md5Threads) {
+    if (md5Threads == 0) {
+        md5Threads = 1;
+    }
+    threads_.emplace_back([this] { RunSha256(); });
+    for (size_t i = 0; i < md5Threads; ++i) {
+        threads_.emplace_back([this] { RunMd5(); });
+    }
+}
+
+PartHasher::~PartHasher() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stopping_ = true;
+    }
+    jobReady_.notify_all();
+    for (auto& thread : threads_) {
+        thread.join();
+    }
+}
+
+void PartHasher::Submit(unsigned int partNumber, std::string_view data,
+                        std::function<void()> done, std::string md5) {
+    auto job = std::make_shared<Job>();
+    job->partNumber = partNumber;
+    job->data = data;
+    job->done = std::move(done);
+    job->md5 = std::move(md5);
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        md5Jobs_.push_back(job);
+        sha256Jobs_.push_back(job);
+        pending_++;
+    }
+    jobReady_.notify_all();  // MD5线程和SHA-256线程各取一份
+}
+
+void PartHasher::Wait() {
+    std::unique_lock<std::mutex> lock(mutex_);
+    jobsDone_.wait(lock, [this] { return pending_ == 0; });
+}
+
+std::map<unsigned int, PartHasher::PartDigest> PartHasher::PartDigests() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return partDigests_;
+}
+
+bool PartHasher::ObjectDigestComplete() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return objectComplete_;
+}
+
+std::string PartHasher::ObjectSha256Hex() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (objectSha256Hex_.empty() && objectComplete_) {
+        objectSha256Hex_ = objectHasher_.FinalHex();
+    }
+    return objectSha256Hex_;
+}
+
+double PartHasher::BusySeconds() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return busySeconds_;
+}
+
+std::shared_ptr<PartHasher::Job> PartHasher::TakeJob(std::deque<std::shared_ptr<Job>>& queue) {
+    std::unique_lock<std::mutex> lock(mutex_);
+    jobReady_.wait(lock, [this, &queue] { return stopping_ || !queue.empty(); });
+    if (queue.empty()) {
+        return nullptr;  // stopping_且没有剩余任务
+    }
+    std::shared_ptr<Job> job = std::move(queue.front());
+    queue.pop_front();
+    return job;
+}
+
+void PartHasher::FinishJob(const std::shared_ptr<Job>& job, double seconds) {
+    bool last;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        busySeconds_ += seconds;
+        last = --job->remaining == 0;
+    }
+    if (!last) {
+        return;
+    }
+    if (job->done) {
+        job->done();  // 先归还缓冲区，再更新计数，Wait()返回时所有回调都已执行
+    }
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        pending_--;
+    }
+    jobsDone_.notify_all();
+}
+
+void PartHasher::RunMd5() {
+    while (std::shared_ptr<Job> job = TakeJob(md5Jobs_)) {
+        auto start = std::chrono::steady_clock::now();
+        if (job->md5.empty()) {
+            ContentHasher md5(DigestAlgorithm::kMd5);
+            md5.Update(job->data.data(), job->data.size());
+            job->md5 = md5.Final();
+        }
+        PartDigest digest;
+        digest.size = job->data.size();
+        digest.md5Hex = ContentHasher::ToHex(job->md5);
+        double seconds =
+            std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            partDigests_[job->partNumber] = std::move(digest);
+        }
+        FinishJob(job, seconds);
+    }
+}
+
+void PartHasher::RunSha256() {
+    while (std::shared_ptr<Job> job = TakeJob(sha256Jobs_)) {
+        // 整体摘要只能按顺序累计：出现编号跳跃后不再更新
+        bool inOrder;
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            inOrder = objectComplete_ && job->partNumber == nextPartNumber_;
+            if (!inOrder) {
+                objectComplete_ = false;
+            }
+            nextPartNumber_ = job->partNumber + 1;
+        }
+        double seconds = 0;
+        if (inOrder) {
+            auto start = std::chrono::steady_clock::now();
+            objectHasher_.Update(job->data.data(), job->data.size());
+            seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        }
+        FinishJob(job, seconds);
+    }
+}
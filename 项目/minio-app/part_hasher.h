@@ -0,0 +1,95 @@
+#pragma once
+
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+#include "content_hasher.h"
+
+/**
+ * 与上传并行的分块摘要计算
+ *
+ * 功能说明：
+ * 1. 分块提交上传的同时提交给哈希线程，哈希与UploadPart读取的是同一块缓冲区，
+ *    不拷贝数据；缓冲区在上传和哈希都结束后才归还，哈希耗时被网络发送时间掩盖
+ * 2. 每个字节只计算一次MD5和一次SHA-256：每个分块的MD5（与分块ETag比对）由多个MD5线程
+ *    并行计算，分块之间互不依赖；整个对象的SHA-256只能按顺序累计，由一个独立线程计算，
+ *    与MD5线程同时读取同一个分块
+ * 3. 分块按编号顺序提交时累计整个对象的SHA-256；编号不连续（如续传跳过分块）时
+ *    整体摘要无法得到，ObjectDigestComplete()返回false，之后的分块只计算MD5
+ *
+ * OpenSSL的EVP接口只提供单缓冲区实现（会自动使用SHA-NI/AVX2等指令），
+ * 没有公开多缓冲区并行哈希接口；吞吐上限取决于顺序的SHA-256线程，
+ * MD5分摊到多个线程后不再与它串行（part_hasher_bench给出实测吞吐）。
+ */
+class PartHasher {
+public:
+    struct PartDigest {
+        size_t size = 0;
+        std::string md5Hex;
+    };
+
+    static constexpr size_t DEFAULT_MD5_THREADS = 2;
+
+    explicit PartHasher(size_t md5Threads = DEFAULT_MD5_THREADS);
+    ~PartHasher();
+
+    PartHasher(const PartHasher&) = delete;
+    PartHasher& operator=(const PartHasher&) = delete;
+
+    // 提交一个分块；data在done被调用之前必须保持有效。done在哈希线程中调用，可为空
+    // md5为暂存阶段已算好的分块MD5原始字节（例如开启完整性校验时），非空时不再重复计算
+    void Submit(unsigned int partNumber, std::string_view data, std::function<void()> done,
+                std::string md5 = std::string());
+
+    // 等待所有已提交的分块计算完成
+    void Wait();
+
+    // 以下在Wait()之后调用
+    std::map<unsigned int, PartDigest> PartDigests() const;
+    bool ObjectDigestComplete() const;
+    std::string ObjectSha256Hex();
+    double BusySeconds() const;  // 各哈希线程实际计算耗时之和
+
+private:
+    struct Job {
+        unsigned int partNumber;
+        std::string_view data;
+        std::function<void()> done;
+        std::string md5;    // 已算好的MD5原始字节，可为空
+        int remaining = 2;  // 尚未结束的计算：MD5和整体SHA-256
+    };
+
+    void RunMd5();
+    void RunSha256();
+    // 取下一个任务，队列为空且正在停止时返回nullptr
+    std::shared_ptr<Job> TakeJob(std::deque<std::shared_ptr<Job>>& queue);
+    // 一项计算结束；两项都结束后归还缓冲区
+    void FinishJob(const std::shared_ptr<Job>& job, double seconds);
+
+    mutable std::mutex mutex_;
+    std::condition_variable jobReady_;
+    std::condition_variable jobsDone_;
+    std::deque<std::shared_ptr<Job>> md5Jobs_;
+    std::deque<std::shared_ptr<Job>> sha256Jobs_;  // 按提交顺序
+    size_t pending_ = 0;  // 已提交未完成的分块数
+    bool stopping_ = false;
+
+    // objectHasher_只在SHA-256线程中修改，其余受mutex_保护；读取方在Wait()之后访问
+    std::map<unsigned int, PartDigest> partDigests_;
+    ContentHasher objectHasher_;
+    unsigned int nextPartNumber_ = 1;
+    bool objectComplete_ = true;
+    std::string objectSha256Hex_;
+    double busySeconds_ = 0;
+
+    std::vector<std::thread> threads_;
+};
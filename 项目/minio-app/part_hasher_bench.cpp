@@ -0,0 +1,104 @@
+#include <algorithm>   // std::min
+#include <chrono>      // 计时
+#include <cstdint>
+#include <cstdlib>     // std::strtoul
+#include <iostream>    // 控制台输出
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "content_hasher.h"  // 单缓冲区摘要
+#include "part_hasher.h"     // 与上传并行的分块摘要
+
+/**
+ * 分块摘要吞吐基准测试
+ *
+ * 功能说明：
+ * 对内存中的一段数据按分块计算上传需要的摘要（每个分块的MD5 + 整个对象的SHA-256），
+ * 不连接MinIO、不读文件，只衡量哈希本身能否跟上网络：
+ * 1. 旧方式：单线程，每个分块同时算MD5和分块SHA-256，另外再累计整体SHA-256（每字节3次摘要）
+ * 2. PartHasher：每字节一次MD5、一次SHA-256，MD5分给1/2/4个线程，SHA-256一个线程
+ *
+ * 输出各方式的吞吐（MB/s），与上传带宽对比即可判断哈希是否在关键路径上。
+ *
+ * 用法: part_hasher_bench [数据大小MB] [分块大小MB]
+ */
+
+namespace {
+
+const size_t MB = 1024 * 1024;
+
+double Seconds(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+// 旧方式：与改造前的PartHasher相同，单线程每字节算三次摘要
+double RunLegacy(const std::vector<char>& data, size_t partSize) {
+    auto start = std::chrono::steady_clock::now();
+    ContentHasher object(DigestAlgorithm::kSha256);
+    for (size_t offset = 0; offset < data.size(); offset += partSize) {
+        size_t length = std::min(partSize, data.size() - offset);
+        ContentHasher md5(DigestAlgorithm::kMd5);
+        ContentHasher sha256(DigestAlgorithm::kSha256);
+        md5.Update(data.data() + offset, length);
+        sha256.Update(data.data() + offset, length);
+        object.Update(data.data() + offset, length);
+        md5.Final();
+        sha256.Final();
+    }
+    object.Final();
+    return Seconds(start);
+}
+
+double RunPartHasher(const std::vector<char>& data, size_t partSize, size_t md5Threads) {
+    auto start = std::chrono::steady_clock::now();
+    PartHasher hasher(md5Threads);
+    unsigned int partNumber = 1;
+    for (size_t offset = 0; offset < data.size(); offset += partSize, partNumber++) {
+        size_t length = std::min(partSize, data.size() - offset);
+        hasher.Submit(partNumber, std::string_view(data.data() + offset, length), nullptr);
+    }
+    hasher.Wait();
+    hasher.ObjectSha256Hex();
+    return Seconds(start);
+}
+
+void Print(const std::string& name, size_t bytes, double seconds) {
+    std::cout << name << ": " << seconds << " 秒 ("
+              << (seconds > 0 ? bytes / static_cast<double>(MB) / seconds : 0) << " MB/s)"
+              << std::endl;
+}
+
+}  // namespace
+
+int main(int argc, char* argv[]) {
+    size_t dataMb = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 512;
+    size_t partMb = argc > 2 ? std::strtoul(argv[2], nullptr, 10) : 16;
+    if (dataMb == 0) {
+        dataMb = 1;
+    }
+    if (partMb == 0) {
+        partMb = 1;
+    }
+
+    // 伪随机填充，避免全零数据让内存和缓存表现失真
+    std::vector<char> data(dataMb * MB);
+    uint32_t state = 2463534242u;
+    for (char& c : data) {
+        state ^= state << 13;
+        state ^= state >> 17;
+        state ^= state << 5;
+        c = static_cast<char>(state);
+    }
+
+    std::cout << "=== 分块摘要吞吐基准测试 ===" << std::endl;
+    std::cout << "数据大小: " << dataMb << "MB，分块大小: " << partMb << "MB" << std::endl;
+
+    size_t partSize = partMb * MB;
+    Print("旧方式 (单线程，MD5+分块SHA-256+整体SHA-256)", data.size(), RunLegacy(data, partSize));
+    for (size_t threads : {1, 2, 4}) {
+        Print("PartHasher (MD5线程 " + std::to_string(threads) + " + SHA-256线程 1)", data.size(),
+              RunPartHasher(data, partSize, threads));
+    }
+    return 0;
+}
@@ -0,0 +1,97 @@
+#include "part_planner.h"
+
+#include <algorithm>
+#include <iostream>
+
+namespace {
+
+// 自适应目标：单个分块上传耗时落在这个区间内
+const double TARGET_MIN_SECONDS = 2.0;
+const double TARGET_MAX_SECONDS = 8.0;
+const double EWMA_WEIGHT = 0.3;  // 新样本在移动平均中的权重
+
+}  // namespace
+
+PartPlanner::PartPlanner(size_t totalSize, size_t concurrency, size_t bufferCount,
+                         size_t memoryBudget, size_t fixedPartSize, bool adaptive)
+    : totalSize_(totalSize), concurrency_(concurrency == 0 ? 1 : concurrency), adaptive_(adaptive) {
+    if (bufferCount == 0) {
+        bufferCount = 1;
+    }
+
+    // 下限：10000个分块要装得下整个文件，且不小于5MB
+    size_t required = std::max(MIN_PART_SIZE, RoundUp((totalSize + MAX_PART_COUNT - 1) / MAX_PART_COUNT));
+
+    // 内存预算平均分给每个暂存缓冲区
+    size_t budgetPerBuffer = std::max(MB, memoryBudget / bufferCount / MB * MB);
+
+    size_t partSize;
+    if (fixedPartSize > 0) {
+        partSize = std::max(required, RoundUp(fixedPartSize));
+    } else {
+        // 每个并发线程至少分到MIN_PARTS_PER_WORKER个分块，否则并发发挥不出来
+        size_t parallelCap = RoundUp(totalSize / (concurrency_ * MIN_PARTS_PER_WORKER));
+        size_t preferred = std::min({budgetPerBuffer, parallelCap, PREFERRED_MAX_PART_SIZE});
+        partSize = std::max(required, preferred);
+    }
+    partSize = std::min(partSize, MAX_PART_SIZE);
+
+    plan_.partSize = partSize;
+    plan_.maxPartSize = adaptive_ ? std::max(partSize, std::min(budgetPerBuffer, MAX_PART_SIZE)) : partSize;
+    plan_.partCount = partSize > 0 ? (totalSize + partSize - 1) / partSize : 0;
+    plan_.memoryBytes = plan_.maxPartSize * bufferCount;
+    plan_.overBudget = plan_.memoryBytes > memoryBudget;
+    currentPartSize_ = partSize;
+}
+
+size_t PartPlanner::StreamPartSize(size_t bufferCount, size_t memoryBudget, size_t fixedPartSize) {
+    if (fixedPartSize > 0) {
+        return std::min(std::max(MIN_PART_SIZE, RoundUp(fixedPartSize)), MAX_PART_SIZE);
+    }
+    if (bufferCount == 0) {
+        bufferCount = 1;
+    }
+    size_t budgetPerBuffer = memoryBudget / bufferCount / MB * MB;
+    return std::min(std::max(MIN_PART_SIZE, budgetPerBuffer), PREFERRED_MAX_PART_SIZE);
+}
+
+size_t PartPlanner::NextPartSize(size_t offset, unsigned int partNumber) {
+    if (!adaptive_) {
+        return plan_.partSize;
+    }
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    // 剩余数据必须能在剩余的分块编号内传完
+    size_t remaining = offset < totalSize_ ? totalSize_ - offset : 0;
+    size_t partsLeft = partNumber <= MAX_PART_COUNT ? MAX_PART_COUNT - partNumber + 1 : 1;
+    size_t lower = std::max(MIN_PART_SIZE, RoundUp((remaining + partsLeft - 1) / partsLeft));
+    return std::min(std::max(currentPartSize_, lower), plan_.maxPartSize);
+}
+
+void PartPlanner::ObservePart(size_t bytes, double seconds) {
+    if (!adaptive_ || bytes < MIN_PART_SIZE) {
+        return;  // 最后一个不足5MB的分块不代表正常分块的耗时
+    }
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    averageSeconds_ = samplesSinceChange_ == 0
+                          ? seconds
+                          : EWMA_WEIGHT * seconds + (1 - EWMA_WEIGHT) * averageSeconds_;
+    // 每次调整后至少收集一轮并发数个样本，避免根据调整前的在途分块反复震荡
+    if (++samplesSinceChange_ < concurrency_) {
+        return;
+    }
+
+    size_t newSize = currentPartSize_;
+    if (averageSeconds_ < TARGET_MIN_SECONDS) {
+        newSize = std::min(currentPartSize_ * 2, plan_.maxPartSize);
+    } else if (averageSeconds_ > TARGET_MAX_SECONDS) {
+        newSize = std::max(RoundUp(currentPartSize_ / 2), MIN_PART_SIZE);
+    }
+    if (newSize != currentPartSize_) {
+        std::cout << "自适应调整分块大小: " << currentPartSize_ / MB << "MB -> " << newSize / MB
+                  << "MB (平均分块耗时 " << averageSeconds_ << " 秒)" << std::endl;
+        currentPartSize_ = newSize;
+        samplesSinceChange_ = 0;
+    }
+}
@@ -0,0 +1,67 @@
+#pragma once
+
+#include <cstddef>
+#include <mutex>
+
+/**
+ * Multipart Upload分块大小规划器
+ *
+ * 功能说明：
+ * 1. 根据文件总大小、并发数、暂存缓冲区数和内存预算选出分块大小：
+ *    - 下限：S3最多10000个分块，分块必须足够大才能装下整个文件；且不小于5MB
+ *    - 上限：所有暂存缓冲区加起来不超过内存预算
+ *    - 在上下限之间尽量取大以减少请求数，但要保证每个并发线程至少分到几个分块
+ * 2. 可选运行期自适应：根据实测的单分块上传耗时调整后续分块大小
+ *    （耗时太短说明每请求固定开销占比高，加大分块；耗时太长说明重传代价大，减小分块）
+ * 3. 长度未知的输入流无法按总大小规划，StreamPartSize()只按内存预算选一个固定分块大小，
+ *    可上传的最大对象为 分块大小 * 10000
+ *
+ * 分块大小按1MB取整，同时满足O_DIRECT读取的对齐要求。
+ * NextPartSize()由读取线程调用，ObservePart()由上传线程调用，内部加锁。
+ */
+class PartPlanner {
+public:
+    static constexpr size_t MB = 1024 * 1024;
+    static constexpr size_t MIN_PART_SIZE = 5 * MB;             // S3最小分块（最后一块除外）
+    static constexpr size_t MAX_PART_SIZE = 5120 * MB;          // S3最大分块 5GB
+    static constexpr size_t MAX_PART_COUNT = 10000;             // S3最大分块数
+    static constexpr size_t PREFERRED_MAX_PART_SIZE = 128 * MB; // 自动规划时的分块上限，限制单次重传代价
+    static constexpr size_t MIN_PARTS_PER_WORKER = 4;           // 每个并发线程至少分到的分块数
+
+    struct Plan {
+        size_t partSize = 0;      // 初始分块大小
+        size_t maxPartSize = 0;   // 分块大小上限（即每个暂存缓冲区的容量）
+        size_t partCount = 0;     // 按初始分块大小计算的请求数
+        size_t memoryBytes = 0;   // 暂存缓冲区总内存
+        bool overBudget = false;  // 为满足10000分块限制而超出了内存预算
+    };
+
+    // fixedPartSize非0时使用指定分块大小（仍会被抬高到满足10000分块限制）
+    PartPlanner(size_t totalSize, size_t concurrency, size_t bufferCount, size_t memoryBudget,
+                size_t fixedPartSize = 0, bool adaptive = false);
+
+    // 长度未知的输入流使用的分块大小：内存预算平均分给每个缓冲区，限制在[5MB, 128MB]内
+    static size_t StreamPartSize(size_t bufferCount, size_t memoryBudget, size_t fixedPartSize = 0);
+
+    const Plan& GetPlan() const { return plan_; }
+    bool Adaptive() const { return adaptive_; }
+
+    // 读取线程调用：第partNumber个分块（从offset开始）应读取的长度，不超过maxPartSize
+    size_t NextPartSize(size_t offset, unsigned int partNumber);
+
+    // 上传线程调用：反馈一个分块的大小和上传耗时
+    void ObservePart(size_t bytes, double seconds);
+
+private:
+    static size_t RoundUp(size_t value) { return (value + MB - 1) / MB * MB; }
+
+    const size_t totalSize_;
+    const size_t concurrency_;
+    const bool adaptive_;
+    Plan plan_;
+
+    std::mutex mutex_;
+    size_t currentPartSize_ = 0;     // 自适应模式下当前使用的分块大小
+    double averageSeconds_ = 0;      // 单分块耗时的指数移动平均
+    size_t samplesSinceChange_ = 0;  // 上次调整后收到的样本数
+};
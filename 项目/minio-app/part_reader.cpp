@@ -0,0 +1,79 @@
+#include "part_reader.h"
+
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+
+PartReader::PartReader(FileReader& reader, size_t totalSize, PartPlanner& planner,
+                       MultipartUploader& uploader)
+    : reader_(reader), totalSize_(totalSize), planner_(planner), uploader_(uploader) {}
+
+PartReader::~PartReader() {
+    Join();
+}
+
+void PartReader::Start() {
+    thread_ = std::thread([this] { Run(); });
+}
+
+void PartReader::Join() {
+    if (thread_.joinable()) {
+        thread_.join();
+    }
+}
+
+void PartReader::Run() {
+    using Clock = std::chrono::steady_clock;
+    unsigned int partNumber = 1;  // 分块编号，从1开始
+    size_t offset = 0;            // 当前分块在文件中的起始位置
+
+    while (offset < totalSize_ && !uploader_.Failed()) {
+        size_t partSize = std::min(planner_.NextPartSize(offset, partNumber), totalSize_ - offset);
+        if (skipParts_.count(partNumber) > 0) {
+            // 续传：该分块已在服务端，直接跳过
+            offset += partSize;
+            stats_.bytesSkipped += partSize;
+            if (progress_ != nullptr) {
+                progress_->AddBytesSkipped(partSize);
+            }
+            partNumber++;
+            continue;
+        }
+
+        auto waitStart = Clock::now();
+        PartBuffer* partBuffer = uploader_.AcquireBuffer();  // 无空闲缓冲区时阻塞
+        auto readStart = Clock::now();
+        stats_.waitSeconds += std::chrono::duration<double>(readStart - waitStart).count();
+
+        // 整个分块一次交给读取后端，直接读入缓冲区
+        size_t length = std::min(partSize, partBuffer->Capacity());
+        size_t bytesRead = 0;
+        bool ok = reader_.ReadAt(partBuffer->Data(), length, offset, bytesRead);
+        stats_.readSeconds += std::chrono::duration<double>(Clock::now() - readStart).count();
+        if (!ok) {
+            lastError_ = reader_.LastError();
+            uploader_.ReleaseBuffer(partBuffer);
+            break;
+        }
+        if (bytesRead == 0) {
+            uploader_.ReleaseBuffer(partBuffer);  // 文件比预期短，没有数据可上传
+            break;
+        }
+        offset += bytesRead;
+        stats_.bytesRead += bytesRead;
+
+        // 缓冲区达到分块大小，或文件读取完毕（最后一个分块）
+        partBuffer->SetSize(bytesRead);
+        if (progress_ != nullptr) {
+            progress_->AddBytesRead(bytesRead);
+        } else {
+            std::cout << "从文件读取到内存: " << bytesRead << " 字节 (总计: " << offset << "/"
+                      << totalSize_ << ")，提交分块 " << partNumber << " 到上传队列" << std::endl;
+        }
+        if (!uploader_.SubmitPart(partNumber, partBuffer)) {
+            break;  // 已有分块失败，停止读取
+        }
+        stats_.partsSubmitted++;
+        partNumber++;
+    }
+}
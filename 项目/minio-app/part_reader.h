@@ -0,0 +1,67 @@
+#pragma once
+
+#include <cstddef>
+#include <set>
+#include <string>
+#include <thread>
+
+#include "file_reader.h"
+#include "multipart_uploader.h"
+#include "part_planner.h"
+#include "progress_reporter.h"
+
+/**
+ * 分块读取线程
+ *
+ * 功能说明：
+ * 1. 独立线程负责读文件：从上传器取空闲暂存缓冲区，通过FileReader把整个分块直接读入，
+ *    读满后提交上传；底层是pread还是io_uring由FileReader决定，分块长度由PartPlanner决定
+ * 2. 上传器持有"并发数+预读深度"个暂存缓冲区，读取线程最多可以领先正在上传的分块
+ *    预读深度个分块；磁盘读取与网络发送重叠，总耗时趋近 max(读盘时间, 网络时间)
+ * 3. 统计读盘耗时与等待空闲缓冲区的耗时：等待时间长说明瓶颈在网络，反之在磁盘
+ * 4. 断点续传时跳过服务端已确认的分块，既不读盘也不上传
+ * 5. 设置了ProgressReporter时只更新其计数器，不再逐分块打印
+ */
+class PartReader {
+public:
+    struct Stats {
+        size_t bytesRead = 0;       // 已读取字节数
+        size_t bytesSkipped = 0;    // 续传跳过的字节数
+        size_t partsSubmitted = 0;  // 已提交上传的分块数
+        double readSeconds = 0;     // 花在文件读取上的时间
+        double waitSeconds = 0;     // 等待空闲缓冲区的时间（上传跟不上读取）
+    };
+
+    // reader: 已打开的文件读取后端；totalSize: 需要上传的总字节数
+    PartReader(FileReader& reader, size_t totalSize, PartPlanner& planner,
+               MultipartUploader& uploader);
+    ~PartReader();
+
+    PartReader(const PartReader&) = delete;
+    PartReader& operator=(const PartReader&) = delete;
+
+    // 须在Start()之前设置：这些编号的分块已在服务端，不再读取上传
+    void SkipParts(std::set<unsigned int> parts) { skipParts_ = std::move(parts); }
+    void SetProgress(ProgressReporter* progress) { progress_ = progress; }
+
+    void Start();
+    void Join();
+
+    // Join()之后调用
+    const Stats& GetStats() const { return stats_; }
+    bool Failed() const { return !lastError_.empty(); }
+    const std::string& LastError() const { return lastError_; }
+
+private:
+    void Run();
+
+    FileReader& reader_;
+    const size_t totalSize_;
+    PartPlanner& planner_;
+    MultipartUploader& uploader_;
+    Stats stats_;
+    std::set<unsigned int> skipParts_;
+    ProgressReporter* progress_ = nullptr;
+    std::string lastError_;
+    std::thread thread_;
+};
@@ -0,0 +1,142 @@
+#include "progress_reporter.h"
+
+#include <unistd.h>  // isatty
+
+namespace {
+
+const double MB = 1024.0 * 1024.0;
+const double RATE_WEIGHT = 0.3;  // 新采样在速率移动平均中的权重
+
+// 秒数格式化为 时:分:秒
+std::string FormatDuration(double seconds) {
+    long total = static_cast<long>(seconds + 0.5);
+    char text[32];
+    std::snprintf(text, sizeof(text), "%02ld:%02ld:%02ld", total / 3600, total / 60 % 60, total % 60);
+    return text;
+}
+
+}  // namespace
+
+ProgressReporter::ProgressReporter(ProgressMode mode, size_t totalBytes,
+                                   std::chrono::milliseconds interval)
+    : mode_(mode), totalBytes_(totalBytes), interval_(interval) {}
+
+ProgressReporter::~ProgressReporter() {
+    Stop();
+}
+
+ProgressMode ProgressReporter::DefaultMode() {
+    return ::isatty(STDERR_FILENO) ? ProgressMode::kTty : ProgressMode::kSilent;
+}
+
+bool ProgressReporter::ParseMode(const std::string& name, ProgressMode& mode) {
+    if (name == "tty") {
+        mode = ProgressMode::kTty;
+    } else if (name == "json") {
+        mode = ProgressMode::kJsonLines;
+    } else if (name == "none") {
+        mode = ProgressMode::kSilent;
+    } else {
+        return false;
+    }
+    return true;
+}
+
+void ProgressReporter::Start() {
+    startTime_ = lastTime_ = std::chrono::steady_clock::now();
+    if (mode_ == ProgressMode::kSilent) {
+        return;  // 静默模式不需要报告线程
+    }
+    thread_ = std::thread([this] { Run(); });
+}
+
+void ProgressReporter::Stop() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (stopping_) {
+            return;
+        }
+        stopping_ = true;
+    }
+    stopCondition_.notify_all();
+    if (thread_.joinable()) {
+        thread_.join();
+        Report(true);
+    }
+}
+
+void ProgressReporter::Run() {
+    std::unique_lock<std::mutex> lock(mutex_);
+    while (!stopCondition_.wait_for(lock, interval_, [this] { return stopping_; })) {
+        lock.unlock();
+        Report(false);
+        lock.lock();
+    }
+}
+
+void ProgressReporter::Report(bool final) {
+    auto now = std::chrono::steady_clock::now();
+    double elapsed = std::chrono::duration<double>(now - startTime_).count();
+    double sinceLast = std::chrono::duration<double>(now - lastTime_).count();
+
+    size_t uploaded = bytesUploaded_.load(std::memory_order_relaxed);
+    size_t done = uploaded + bytesSkipped_.load(std::memory_order_relaxed);
+    size_t read = bytesRead_.load(std::memory_order_relaxed);
+    long inFlight = partsInFlight_.load(std::memory_order_relaxed);
+    size_t partsDone = partsDone_.load(std::memory_order_relaxed);
+    long objectsInFlight = objectsInFlight_.load(std::memory_order_relaxed);
+    size_t objectsDone = objectsDone_.load(std::memory_order_relaxed);
+
+    if (sinceLast > 0) {
+        // 重试回滚可能让计数暂时变小，此时按0速率处理
+        double rate = uploaded > lastUploaded_ ? (uploaded - lastUploaded_) / sinceLast : 0;
+        smoothedRate_ = lastUploaded_ == 0 && smoothedRate_ == 0
+                            ? rate
+                            : RATE_WEIGHT * rate + (1 - RATE_WEIGHT) * smoothedRate_;
+    }
+    lastTime_ = now;
+    lastUploaded_ = uploaded;
+
+    double averageRate = elapsed > 0 ? uploaded / elapsed : 0;
+    double rate = final ? averageRate : smoothedRate_;
+    double eta = -1;  // 未知
+    if (totalBytes_ > 0 && rate > 0) {
+        eta = done < totalBytes_ ? (totalBytes_ - done) / rate : 0;
+    }
+
+    if (mode_ == ProgressMode::kJsonLines) {
+        std::fprintf(stderr,
+                     "{\"elapsed_seconds\":%.2f,\"bytes_read\":%zu,\"bytes_done\":%zu,"
+                     "\"total_bytes\":%zu,\"rate_mb_per_s\":%.2f,\"eta_seconds\":%.1f,"
+                     "\"parts_in_flight\":%ld,\"parts_done\":%zu,\"objects_in_flight\":%ld,"
+                     "\"objects_done\":%zu,\"final\":%s}\n",
+                     elapsed, read, done, totalBytes_, rate / MB, eta, inFlight, partsDone,
+                     objectsInFlight, objectsDone, final ? "true" : "false");
+        std::fflush(stderr);
+        return;
+    }
+
+    char objects[96] = "";
+    if (objectsInFlight > 0 || objectsDone > 0) {
+        std::snprintf(objects, sizeof(objects), "在途对象 %ld  已完成对象 %zu  ", objectsInFlight,
+                      objectsDone);
+    }
+    char line[320];
+    if (totalBytes_ > 0) {
+        std::snprintf(line, sizeof(line),
+                      "\r%s %.1f/%.1f MB (%5.1f%%)  %.1f MB/s  %s在途分块 %ld  已完成 %zu  剩余 %s   ",
+                      label_, done / MB, totalBytes_ / MB, 100.0 * done / totalBytes_, rate / MB,
+                      objects, inFlight, partsDone,
+                      eta < 0 ? "--:--:--" : FormatDuration(eta).c_str());
+    } else {
+        std::snprintf(line, sizeof(line),
+                      "\r%s %.1f MB  %.1f MB/s  %s在途分块 %ld  已完成 %zu  用时 %s   ",
+                      label_, done / MB, rate / MB, objects, inFlight, partsDone,
+                      FormatDuration(elapsed).c_str());
+    }
+    std::fputs(line, stderr);
+    if (final) {
+        std::fputc('\n', stderr);
+    }
+    std::fflush(stderr);
+}
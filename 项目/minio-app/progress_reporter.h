@@ -0,0 +1,102 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdio>
+#include <mutex>
+#include <string>
+#include <thread>
+
+/**
+ * 异步限频的进度报告
+ *
+ * 功能说明：
+ * 1. 读取线程和上传线程只对原子计数器做加减，不在数据路径上格式化或刷新输出
+ * 2. 独立的报告线程按固定间隔采样计数器，输出吞吐量、剩余时间和在途分块数
+ *    （批量上传另有在途/已完成对象数）；
+ *    输出频率与分块大小、文件大小无关，终端或日志管道不会成为瓶颈
+ * 3. 三种模式：
+ *    - kTty：在stderr上用回车覆盖同一行，适合交互终端
+ *    - kJsonLines：每个间隔向stderr输出一行JSON，便于脚本和日志系统解析
+ *    - kSilent：不输出，计数器照常工作
+ *
+ * 总长度未知（流输入）时不显示百分比和剩余时间。
+ */
+enum class ProgressMode {
+    kTty,        // 终端单行刷新
+    kJsonLines,  // 每行一个JSON对象
+    kSilent,     // 不输出
+};
+
+class ProgressReporter {
+public:
+    // totalBytes为0表示总长度未知
+    ProgressReporter(ProgressMode mode, size_t totalBytes,
+                     std::chrono::milliseconds interval = std::chrono::milliseconds(1000));
+    ~ProgressReporter();
+
+    ProgressReporter(const ProgressReporter&) = delete;
+    ProgressReporter& operator=(const ProgressReporter&) = delete;
+
+    // stderr是终端时用kTty，否则kSilent
+    static ProgressMode DefaultMode();
+    // 解析"tty"/"json"/"none"，无法识别返回false
+    static bool ParseMode(const std::string& name, ProgressMode& mode);
+
+    void Start();
+    // 停止报告线程并输出最终进度；析构时自动调用
+    void Stop();
+
+    ProgressMode Mode() const { return mode_; }
+    // 终端模式下完成字节数前的说明文字，默认"已上传"；须在Start()之前设置
+    void SetLabel(const char* label) { label_ = label; }
+
+    // 以下接口可在任意线程调用，只做原子操作
+    void AddBytesRead(size_t bytes) { bytesRead_.fetch_add(bytes, std::memory_order_relaxed); }
+    void AddBytesUploaded(size_t bytes) { bytesUploaded_.fetch_add(bytes, std::memory_order_relaxed); }
+    // 请求失败重试时撤销该请求已计入的字节
+    void RollbackBytesUploaded(size_t bytes) { bytesUploaded_.fetch_sub(bytes, std::memory_order_relaxed); }
+    // 续传跳过的字节计入完成进度，但不计入吞吐量
+    void AddBytesSkipped(size_t bytes) { bytesSkipped_.fetch_add(bytes, std::memory_order_relaxed); }
+    void PartStarted() { partsInFlight_.fetch_add(1, std::memory_order_relaxed); }
+    void PartFinished() {
+        partsInFlight_.fetch_sub(1, std::memory_order_relaxed);
+        partsDone_.fetch_add(1, std::memory_order_relaxed);
+    }
+    // 批量上传按对象计数，与Multipart Upload的分块计数分开；没有对象计数时不显示
+    void ObjectStarted() { objectsInFlight_.fetch_add(1, std::memory_order_relaxed); }
+    void ObjectFinished() {
+        objectsInFlight_.fetch_sub(1, std::memory_order_relaxed);
+        objectsDone_.fetch_add(1, std::memory_order_relaxed);
+    }
+
+private:
+    void Run();
+    void Report(bool final);
+
+    const ProgressMode mode_;
+    const size_t totalBytes_;
+    const std::chrono::milliseconds interval_;
+    const char* label_ = "已上传";
+
+    alignas(64) std::atomic<size_t> bytesRead_{0};
+    alignas(64) std::atomic<size_t> bytesUploaded_{0};
+    std::atomic<size_t> bytesSkipped_{0};
+    std::atomic<long> partsInFlight_{0};
+    std::atomic<size_t> partsDone_{0};
+    std::atomic<long> objectsInFlight_{0};
+    std::atomic<size_t> objectsDone_{0};
+
+    // 仅报告线程（及Stop()之后的调用线程）访问
+    std::chrono::steady_clock::time_point startTime_;
+    std::chrono::steady_clock::time_point lastTime_;
+    size_t lastUploaded_ = 0;
+    double smoothedRate_ = 0;  // 字节/秒的指数移动平均
+
+    std::mutex mutex_;
+    std::condition_variable stopCondition_;
+    bool stopping_ = false;
+    std::thread thread_;
+};
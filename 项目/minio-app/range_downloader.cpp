@@ -0,0 +1,321 @@
+#include "range_downloader.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <cstring>
+#include <exception>
+#include <iostream>
+#include <thread>
+#include <fcntl.h>     // open
+#include <sys/stat.h>  // stat，续传时检查输出文件
+#include <unistd.h>    // ftruncate, fdatasync, close, unlink
+
+#include "part_compressor.h"  // CODEC_METADATA_KEY
+#include "part_encryptor.h"   // ObjectCipher::METADATA_KEY
+
+RangeDownloader::RangeDownloader(const MinioConfig& config, std::string bucket,
+                                 std::string object, size_t concurrency, size_t rangeSize)
+    : bucket_(std::move(bucket)),
+      object_(std::move(object)),
+      rangeSize_(rangeSize == 0 ? DEFAULT_RANGE_SIZE : rangeSize) {
+    if (concurrency == 0) {
+        concurrency = 1;
+    }
+    retryBudget_ = std::make_unique<RetryBudget>(DEFAULT_RETRY_BUDGET);
+    for (size_t i = 0; i < concurrency; ++i) {
+        connections_.push_back(std::make_unique<MinioConnection>(config));
+    }
+    // 排队容量取线程数的两倍：工作线程完成一个范围时下一个已在队列中
+    pool_ = std::make_unique<ThreadPool>(concurrency, concurrency * 2);
+}
+
+RangeDownloader::~RangeDownloader() {
+    pool_->Wait();
+    sinks_.clear();  // 先等写线程退出再关闭文件
+    if (directFd_ >= 0) {
+        ::close(directFd_);
+    }
+    if (fd_ >= 0) {
+        ::close(fd_);
+    }
+}
+
+void RangeDownloader::SetError(const std::string& message) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (lastError_.empty()) {
+        lastError_ = message;  // 只保留第一个错误，后续多半是它引起的
+    }
+    failed_ = true;
+}
+
+size_t RangeDownloader::RangeCount() const {
+    return (objectSize_ + rangeSize_ - 1) / rangeSize_;
+}
+
+bool RangeDownloader::Stat() {
+    minio::s3::StatObjectArgs statArgs;
+    statArgs.bucket = bucket_;
+    statArgs.object = object_;
+
+    minio::s3::StatObjectResponse statResp;
+    std::string error;
+    if (!RetryCall(retryPolicy_, *retryBudget_, object_, [&] {
+            return connections_[0]->Client().StatObject(statArgs);
+        }, statResp, error)) {
+        SetError("获取对象信息失败: " + error);
+        return false;
+    }
+    // 压缩或加密的对象由minio_basic流式解压解密；这里按字节范围并发写盘，写出的是存储格式
+    std::string codec = statResp.user_metadata.GetFront(PartCompressor::CODEC_METADATA_KEY);
+    if (!codec.empty()) {
+        SetError("对象以" + codec + "压缩存储（" + PartCompressor::CODEC_METADATA_KEY + ": " +
+                 codec + "），分段下载不支持解压，请使用minio_basic下载");
+        return false;
+    }
+    std::string encryption = statResp.user_metadata.GetFront(ObjectCipher::METADATA_KEY);
+    if (!encryption.empty()) {
+        SetError("对象在客户端加密存储（" + std::string(ObjectCipher::METADATA_KEY) + ": " +
+                 encryption + "），分段下载不支持解密，请使用minio_basic下载");
+        return false;
+    }
+    objectSize_ = statResp.size;
+    etag_ = statResp.etag;
+    return true;
+}
+
+bool RangeDownloader::LoadJournal(const std::string& path) {
+    journalEnabled_ = true;
+    std::string journalPath = DownloadJournal::PathFor(path);
+    DownloadJournal::State state;
+    if (!DownloadJournal::Load(journalPath, state)) {
+        return true;  // 没有可用的旧日志，Download()时新建
+    }
+
+    struct stat st;
+    bool sameObject = state.bucket == bucket_ && state.object == object_;
+    if (sameObject && state.etag == etag_ && state.objectSize == objectSize_ &&
+        ::stat(path.c_str(), &st) == 0 && static_cast<size_t>(st.st_size) == objectSize_) {
+        // 沿用上次的范围划分，日志中的偏移才能与本次的范围一一对应
+        rangeSize_ = state.rangeSize;
+        completed_ = std::move(state.ranges);
+        if (!journal_.OpenForAppend(journalPath)) {
+            SetError(journal_.LastError());
+            return false;
+        }
+        resumed_ = true;
+        return true;
+    }
+
+    if (sameObject && state.etag != etag_) {
+        std::cout << "对象在上次下载后已变化（ETag " << state.etag << " -> " << etag_
+                  << "），丢弃已下载的部分，从头下载" << std::endl;
+    } else {
+        std::cout << "续传日志与本次下载不符，从头下载" << std::endl;
+    }
+    return true;
+}
+
+bool RangeDownloader::Download(const std::string& path) {
+    auto startTime = std::chrono::steady_clock::now();
+    // 续传时保留已下载的内容，其余情况清空旧文件
+    int flags = O_WRONLY | O_CREAT | O_CLOEXEC | (resumed_ ? 0 : O_TRUNC);
+    fd_ = ::open(path.c_str(), flags, 0644);
+    if (fd_ < 0) {
+        SetError("无法创建输出文件 " + path + ": " + std::strerror(errno));
+        return false;
+    }
+    // 先按对象大小一次分配文件空间：各范围按偏移写入，写入顺序任意，文件也不会碎成很多extent
+    std::string error;
+    if (!WriteBehindSink::Preallocate(fd_, objectSize_, error)) {
+        SetError(error + " (" + path + ")");
+    }
+    std::string warning;
+    if (directIo_) {
+        directFd_ = ::open(path.c_str(), O_WRONLY | O_CLOEXEC | O_DIRECT);
+        if (directFd_ < 0) {
+            // tmpfs等不支持O_DIRECT时open返回EINVAL
+            warning = std::string("无法以O_DIRECT打开输出文件: ") + std::strerror(errno) +
+                      "，退回普通写入";
+        }
+    }
+    for (size_t i = 0; i < connections_.size(); ++i) {
+        sinks_.push_back(std::make_unique<WriteBehindSink>(fd_, writerBackend_, warning));
+        sinks_.back()->SetDirectFd(directFd_);
+    }
+    if (!warning.empty()) {
+        std::cerr << "警告: " << warning << std::endl;
+    }
+    if (journalEnabled_ && !resumed_ && !failed_) {
+        DownloadJournal::State header;
+        header.bucket = bucket_;
+        header.object = object_;
+        header.etag = etag_;
+        header.objectSize = objectSize_;
+        header.rangeSize = rangeSize_;
+        if (!journal_.Create(DownloadJournal::PathFor(path), header)) {
+            SetError(journal_.LastError());
+        }
+    }
+
+    size_t ranges = RangeCount();
+    for (size_t i = 0; i < ranges && !failed_; ++i) {
+        size_t offset = i * rangeSize_;
+        size_t length = std::min(rangeSize_, objectSize_ - offset);
+        auto it = completed_.find(offset);
+        if (it != completed_.end() && it->second == length) {
+            rangesSkipped_++;
+            bytesSkipped_ += length;
+            if (progress_ != nullptr) {
+                progress_->AddBytesSkipped(length);
+            }
+            continue;
+        }
+        pool_->Submit([this, i, offset, length](size_t workerIndex) {
+            FetchRange(workerIndex, i, offset, length);
+        });
+    }
+    pool_->Wait();
+
+    // 各范围结束时已经Flush()，这里只收集统计并停止写线程
+    for (const auto& sink : sinks_) {
+        WriteBehindSink::Stats sinkStats = sink->GetStats();
+        writeStalls_ += sinkStats.stalls;
+        writeStallSeconds_ += sinkStats.stallSeconds;
+    }
+    sinks_.clear();
+    if (directFd_ >= 0) {
+        ::close(directFd_);
+        directFd_ = -1;
+    }
+    if (!failed_ && ::fsync(fd_) != 0) {
+        SetError("写入输出文件失败 " + path + ": " + std::strerror(errno));
+    }
+    ::close(fd_);
+    fd_ = -1;
+    elapsedSeconds_ =
+        std::chrono::duration<double>(std::chrono::steady_clock::now() - startTime).count();
+    if (failed_) {
+        if (!journalEnabled_) {
+            ::unlink(path.c_str());  // 不完整的文件没有用处，避免被误当作下载结果
+        }
+        return false;
+    }
+    if (journalEnabled_) {
+        journal_.Remove();  // 下载已完成，续传日志不再需要
+    }
+    return true;
+}
+
+void RangeDownloader::FetchRange(size_t workerIndex, size_t index, size_t offset, size_t length) {
+    if (failed_) {
+        return;  // 已有范围失败，不再发起新的请求
+    }
+    if (progress_ != nullptr) {
+        progress_->PartStarted();
+    }
+
+    std::string what = object_ + " 范围" + std::to_string(index);
+    WriteBehindSink& sink = *sinks_[workerIndex];
+    size_t written = 0;  // 本范围已写入文件的字节数，重试时从这里继续
+    std::string writeError;
+    std::string error;
+    bool done = false;
+    for (unsigned int attempt = 1;; ++attempt) {
+        bool retryable = true;
+        size_t requestOffset = offset + written;
+        size_t requestLength = length - written;
+        minio::s3::GetObjectArgs args;
+        args.bucket = bucket_;
+        args.object = object_;
+        args.offset = &requestOffset;
+        args.length = &requestLength;
+        args.match_etag = etag_;  // 对象在下载期间被覆盖时返回412，而不是新旧数据混杂
+        args.datafunc = [&](minio::http::DataFunctionArgs dataArgs) -> bool {
+            const std::string& chunk = dataArgs.datachunk;
+            if (chunk.size() > length - written) {
+                writeError = "服务端返回的数据超出请求范围";
+                return false;
+            }
+            if (bandwidth_ != nullptr) {
+                bandwidth_->Consume(chunk.size());
+            }
+            // 只拷进写缓冲区，落盘由接收器的写线程完成
+            if (!sink.Write(offset + written, chunk.data(), chunk.size())) {
+                writeError = sink.LastError();
+                return false;  // 让SDK中止这次请求
+            }
+            written += chunk.size();
+            bytesDownloaded_ += chunk.size();
+            if (progress_ != nullptr) {
+                progress_->AddBytesUploaded(chunk.size());
+            }
+            return !failed_;  // 其他范围已失败时尽快放弃本范围
+        };
+
+        try {
+            minio::s3::GetObjectResponse resp = connections_[workerIndex]->Client().GetObject(args);
+            if (resp && written == length) {
+                done = true;
+                break;
+            }
+            error = resp ? "连接提前关闭，范围数据不完整" : resp.Error().String();
+            retryable = resp || IsRetryableResponse(resp);
+        } catch (const std::exception& e) {
+            error = e.what();  // SDK内部抛出的网络异常同样视为瞬时错误
+        }
+
+        // 本地写入失败和其他范围已失败都不是重试能解决的
+        if (!writeError.empty()) {
+            error = writeError;
+            break;
+        }
+        if (failed_ || !retryable || attempt >= retryPolicy_.maxAttempts) {
+            break;
+        }
+        if (!retryBudget_->TryConsume()) {
+            error += "（重试预算已耗尽）";
+            break;
+        }
+        std::chrono::milliseconds delay = retryPolicy_.Backoff(attempt);
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            std::cerr << what << " 第" << attempt << "次请求失败: " << error << "，已写入 "
+                      << written << "/" << length << " 字节，" << delay.count() << " 毫秒后重试"
+                      << std::endl;
+        }
+        std::this_thread::sleep_for(delay);
+    }
+
+    // 本范围的数据全部写入文件后才算完成，后面的fdatasync和日志记录才有意义
+    if (!sink.Flush() && writeError.empty()) {
+        done = false;
+        error = sink.LastError();
+    }
+    if (progress_ != nullptr) {
+        progress_->PartFinished();
+    }
+    if (done) {
+        rangesDownloaded_++;
+        // 先让本范围的数据落盘再记日志：日志中的范围在崩溃后一定可用
+        if (journalEnabled_ && (::fdatasync(fd_) != 0 || !journal_.RecordRange(offset, length))) {
+            std::lock_guard<std::mutex> lock(mutex_);
+            std::cerr << "警告: " << what << " 未能记入续传日志" << std::endl;
+        }
+    } else if (!failed_) {
+        SetError(what + " 下载失败: " + error);
+    }
+}
+
+RangeDownloader::Stats RangeDownloader::GetStats() const {
+    Stats stats;
+    stats.rangesDownloaded = rangesDownloaded_;
+    stats.bytesDownloaded = bytesDownloaded_;
+    stats.rangesSkipped = rangesSkipped_;
+    stats.bytesSkipped = bytesSkipped_;
+    stats.retries = retryBudget_->Used();
+    stats.writeStalls = writeStalls_;
+    stats.writeStallSeconds = writeStallSeconds_;
+    stats.elapsedSeconds = elapsedSeconds_;
+    return stats;
+}
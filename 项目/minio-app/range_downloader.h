@@ -0,0 +1,146 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "bandwidth_governor.h"
+#include "download_journal.h"
+#include "minio_connection.h"
+#include "progress_reporter.h"
+#include "retry_policy.h"
+#include "thread_pool.h"
+#include "write_behind_sink.h"
+
+/**
+ * 并发分段下载器
+ *
+ * 功能说明：
+ * 1. 先StatObject（HEAD）取得对象大小和ETag，把对象切成固定大小的字节范围；对象带有
+ *    content-codec（zstd压缩）或client-encryption（客户端加密）元数据时按原样写出的文件
+ *    不可用，分段下载不做解压解密，Stat()直接报错
+ * 2. 各范围在有界线程池上以带offset/length的GetObject并发下载，每个工作线程持有独立的
+ *    MinIO客户端；单个对象不再受限于一条TCP连接和一个核
+ * 3. 目标文件先扩展到对象大小，SDK回调的每段数据按该范围内的偏移写入，不在内存中按顺序重排；
+ *    回调只把数据拷进WriteBehindSink的大缓冲区，由后台写线程（pwrite或io_uring）整块落盘，
+ *    磁盘变慢时curl接收线程不会卡在write上；文件空间用fallocate一次分配，避免extent碎片
+ * 4. 每个范围请求都带If-Match: ETag，下载期间对象被覆盖时服务端返回412，不会拼出
+ *    新旧内容混杂的文件
+ * 5. 范围失败时按RetryPolicy退避重试，从已写入的位置继续请求剩余部分，整个下载共享重试预算
+ * 6. 可选ProgressReporter和BandwidthGovernor::Transfer，与上传器的用法相同
+ * 7. 可选断点续传：范围数据fdatasync后记入DownloadJournal；重新运行时ETag未变则沿用原来的
+ *    范围划分，只请求缺失的范围（仍带If-Match），对象已变化则丢弃旧文件从头下载；
+ *    续传模式下失败时保留输出文件和日志
+ *
+ * 使用流程：
+ *   RangeDownloader downloader(config, bucket, object, 8, 16 * MB);
+ *   downloader.Stat();
+ *   downloader.LoadJournal(path);  // 可选：断点续传
+ *   downloader.Download(path);
+ */
+class RangeDownloader {
+public:
+    struct Stats {
+        size_t rangesDownloaded = 0;  // 已完成的范围数
+        size_t bytesDownloaded = 0;   // 已写入文件的字节数
+        size_t rangesSkipped = 0;     // 续传时跳过的已完成范围数
+        size_t bytesSkipped = 0;      // 续传时跳过的字节数
+        size_t retries = 0;           // 全部请求累计重试次数
+        size_t writeStalls = 0;       // 接收线程等待写缓冲区的次数
+        double writeStallSeconds = 0; // 接收线程等待写缓冲区的总时长
+        double elapsedSeconds = 0;    // Download()的耗时
+
+        double MegabytesPerSecond() const {
+            return elapsedSeconds > 0 ? bytesDownloaded / 1024.0 / 1024.0 / elapsedSeconds : 0;
+        }
+    };
+
+    static constexpr size_t DEFAULT_RANGE_SIZE = 16 * 1024 * 1024;
+    static constexpr size_t DEFAULT_RETRY_BUDGET = 100;  // 默认整个下载最多重试100次
+
+    // concurrency: 同时下载的范围数（工作线程数）；rangeSize: 每个范围的字节数
+    RangeDownloader(const MinioConfig& config, std::string bucket, std::string object,
+                    size_t concurrency, size_t rangeSize);
+    ~RangeDownloader();
+
+    RangeDownloader(const RangeDownloader&) = delete;
+    RangeDownloader& operator=(const RangeDownloader&) = delete;
+
+    // 以下设置须在Download()之前调用
+    void SetRetryPolicy(const RetryPolicy& policy, size_t retryBudget) {
+        retryPolicy_ = policy;
+        retryBudget_ = std::make_unique<RetryBudget>(retryBudget);
+    }
+    void SetProgress(ProgressReporter* progress) { progress_ = progress; }
+    // transfer须比下载器存活更久
+    void SetBandwidth(BandwidthGovernor::Transfer* transfer) { bandwidth_ = transfer; }
+    // 输出文件的写入后端，默认pwrite
+    void SetWriter(WriterBackend backend) { writerBackend_ = backend; }
+    // 以O_DIRECT写入对齐的数据，绕过页缓存；文件系统不支持时退回普通写入
+    void SetDirectIo(bool direct) { directIo_ = direct; }
+
+    // 步骤1：查询对象大小和ETag
+    bool Stat();
+    // 步骤1（续传）：启用续传日志并读取path旁的旧日志；日志中的ETag、对象大小与Stat()一致
+    // 且输出文件仍在时沿用其范围大小、跳过已完成的范围，否则从头下载。只有打开日志失败时返回false
+    bool LoadJournal(const std::string& path);
+    // 步骤2：下载到path；未续传时覆盖已有文件，失败时删除不完整的文件（续传模式下保留）
+    bool Download(const std::string& path);
+
+    size_t ObjectSize() const { return objectSize_; }
+    const std::string& Etag() const { return etag_; }
+    size_t RangeCount() const;
+    size_t RangeSize() const { return rangeSize_; }
+    // LoadJournal()找到可以续传的旧日志
+    bool Resumed() const { return resumed_; }
+    size_t CompletedRangeCount() const { return completed_.size(); }
+    const std::string& LastError() const { return lastError_; }
+    Stats GetStats() const;
+
+private:
+    // 在工作线程中下载[offset, offset+length)并写入fd
+    void FetchRange(size_t workerIndex, size_t index, size_t offset, size_t length);
+    void SetError(const std::string& message);
+
+    const std::string bucket_;
+    const std::string object_;
+    size_t rangeSize_;
+    size_t objectSize_ = 0;
+    std::string etag_;
+    RetryPolicy retryPolicy_;
+    std::unique_ptr<RetryBudget> retryBudget_;
+    ProgressReporter* progress_ = nullptr;
+    BandwidthGovernor::Transfer* bandwidth_ = nullptr;
+    WriterBackend writerBackend_ = WriterBackend::kPwrite;
+    bool directIo_ = false;
+    int fd_ = -1;
+    int directFd_ = -1;  // 以O_DIRECT打开的同一文件，未启用时为-1
+    // 每个工作线程一个写后台接收器，SDK回调只做内存拷贝，由接收器的写线程落盘
+    std::vector<std::unique_ptr<WriteBehindSink>> sinks_;
+
+    bool journalEnabled_ = false;
+    bool resumed_ = false;
+    DownloadJournal journal_;
+    std::map<uint64_t, size_t> completed_;  // 续传时已完成的范围：偏移 -> 长度
+
+    std::vector<std::unique_ptr<MinioConnection>> connections_;  // 每个工作线程一个
+
+    std::mutex mutex_;  // 保护lastError_和输出
+    std::string lastError_;
+    std::atomic<bool> failed_{false};
+    std::atomic<size_t> rangesDownloaded_{0};
+    std::atomic<size_t> bytesDownloaded_{0};
+    size_t rangesSkipped_ = 0;
+    size_t bytesSkipped_ = 0;
+    size_t writeStalls_ = 0;
+    double writeStallSeconds_ = 0;
+    double elapsedSeconds_ = 0;
+
+    // 最后声明，最先析构：保证工作线程退出后才销毁上面的连接和状态
+    std::unique_ptr<ThreadPool> pool_;
+};
@@ -0,0 +1,108 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <exception>
+#include <iostream>
+#include <random>
+#include <string>
+#include <thread>
+#include <miniocpp/client.h>  // MinIO C++ SDK主要头文件
+
+/**
+ * 请求重试策略
+ *
+ * 功能说明：
+ * 1. 指数退避 + 全抖动（full jitter）：第n次重试前等待 [0, min(maxDelay, baseDelay*2^n)) 内的随机时间，
+ *    避免大量并发分块在同一时刻一起重试，再次触发服务端限流（503 SlowDown）
+ * 2. 只重试瞬时错误：网络错误、5xx、408/429以及SlowDown等错误码；权限、参数类错误立即失败
+ * 3. RetryBudget限制整个上传过程的重试总次数，服务端持续故障时尽快放弃，而不是每个分块各自重试到底
+ */
+struct RetryPolicy {
+    unsigned int maxAttempts = 5;                    // 单个请求最多尝试次数（含第一次）
+    std::chrono::milliseconds baseDelay{200};        // 退避基准时间
+    std::chrono::milliseconds maxDelay{10000};       // 单次退避上限
+
+    // 第attempt次失败后的等待时间（attempt从1开始）
+    std::chrono::milliseconds Backoff(unsigned int attempt) const {
+        thread_local std::mt19937_64 rng{std::random_device{}()};
+        long long cap = baseDelay.count() << std::min(attempt, 20u);
+        cap = std::min<long long>(cap, maxDelay.count());
+        std::uniform_int_distribution<long long> dist(0, std::max(cap, 1LL) - 1);
+        return std::chrono::milliseconds(dist(rng));
+    }
+};
+
+// 整个上传共享的重试次数预算，可在多个上传线程中并发使用
+class RetryBudget {
+public:
+    explicit RetryBudget(size_t maxRetries) : remaining_(maxRetries) {}
+
+    // 消耗一次重试机会；预算耗尽返回false
+    bool TryConsume() {
+        size_t current = remaining_.load();
+        while (current > 0) {
+            if (remaining_.compare_exchange_weak(current, current - 1)) {
+                used_++;
+                return true;
+            }
+        }
+        return false;
+    }
+
+    size_t Used() const { return used_; }
+
+private:
+    std::atomic<size_t> remaining_;
+    std::atomic<size_t> used_{0};
+};
+
+// 判断失败的响应是否值得重试
+// RequestTimeTooSkewed（本机时钟偏差过大，403）不在其中：退避重试修不好时钟，只会耗尽重试预算
+inline bool IsRetryableResponse(const minio::s3::Response& resp) {
+    if (resp.code == "SlowDown" || resp.code == "RequestTimeout" || resp.code == "InternalError" ||
+        resp.code == "ServiceUnavailable") {
+        return true;
+    }
+    // status_code为0表示没有收到HTTP响应：连接失败、连接被重置、超时等网络错误
+    return resp.status_code == 0 || resp.status_code == 408 || resp.status_code == 429 ||
+           resp.status_code >= 500;
+}
+
+/**
+ * 执行一次S3请求，失败且可重试时按policy退避后重试，每次重试消耗budget中的一次机会
+ *
+ * call每次被调用都要发出一个完整的请求（例如PutObject需要在call内重新构造输入流）。
+ * 成功返回true；最终失败返回false，error为最后一次失败的原因。
+ */
+template <typename Response, typename Call>
+bool RetryCall(const RetryPolicy& policy, RetryBudget& budget, const std::string& what, Call call,
+               Response& resp, std::string& error) {
+    for (unsigned int attempt = 1;; ++attempt) {
+        bool retryable = true;
+        try {
+            resp = call();
+            if (resp) {
+                return true;
+            }
+            error = resp.Error().String();
+            retryable = IsRetryableResponse(resp);
+        } catch (const std::exception& e) {
+            error = e.what();  // SDK内部抛出的网络异常同样视为瞬时错误
+        }
+
+        if (!retryable || attempt >= policy.maxAttempts) {
+            return false;
+        }
+        if (!budget.TryConsume()) {
+            error += "（重试预算已耗尽）";
+            return false;
+        }
+        std::chrono::milliseconds delay = policy.Backoff(attempt);
+        std::cerr << what << " 第" << attempt << "次请求失败: " << error << "，" << delay.count()
+                  << " 毫秒后重试" << std::endl;
+        std::this_thread::sleep_for(delay);
+    }
+}
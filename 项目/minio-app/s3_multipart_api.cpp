@@ -0,0 +1,166 @@
+#include "s3_multipart_api.h"
+
+#include <cstdio>       // std::sscanf
+#include <pugixml.hpp>  // SDK依赖的XML解析库
+
+namespace {
+
+const char* MAX_PARTS_PER_PAGE = "1000";    // ListParts单页最大分块数
+const char* MAX_UPLOADS_PER_PAGE = "1000";  // ListMultipartUploads单页最大条数
+
+// 解析S3响应中的ISO 8601时间，如 2024-05-01T08:30:00.000Z
+std::time_t ParseIso8601(const char* text) {
+    std::tm tm = {};
+    if (std::sscanf(text, "%d-%d-%dT%d:%d:%d", &tm.tm_year, &tm.tm_mon, &tm.tm_mday, &tm.tm_hour,
+                    &tm.tm_min, &tm.tm_sec) != 6) {
+        return 0;
+    }
+    tm.tm_year -= 1900;
+    tm.tm_mon -= 1;
+    return ::timegm(&tm);
+}
+
+// 原始请求需要bucket所在的region参与签名
+bool GetRegion(MinioConnection& connection, const std::string& bucket, std::string& region,
+               std::string& error) {
+    minio::s3::GetRegionResponse regionResp = connection.Client().GetRegion(bucket);
+    if (!regionResp) {
+        error = "获取bucket区域失败: " + regionResp.Error().String();
+        return false;
+    }
+    region = regionResp.region;
+    return true;
+}
+
+}  // namespace
+
+std::string TrimEtag(const std::string& etag) {
+    size_t begin = 0;
+    size_t end = etag.size();
+    while (begin < end && etag[begin] == '"') {
+        ++begin;
+    }
+    while (end > begin && etag[end - 1] == '"') {
+        --end;
+    }
+    return etag.substr(begin, end - begin);
+}
+
+bool ListParts(MinioConnection& connection, const std::string& bucket, const std::string& object,
+               const std::string& uploadId, ListPartsResult& result, std::string& error) {
+    result = ListPartsResult();
+
+    std::string region;
+    if (!GetRegion(connection, bucket, region, error)) {
+        return false;
+    }
+
+    unsigned int marker = 0;  // 从该分块编号之后继续列出
+    for (;;) {
+        minio::utils::Multimap queryParams;
+        queryParams.Add("uploadId", uploadId);
+        queryParams.Add("max-parts", MAX_PARTS_PER_PAGE);
+        if (marker > 0) {
+            queryParams.Add("part-number-marker", std::to_string(marker));
+        }
+
+        minio::s3::Request req(minio::http::Method::kGet, region, connection.Url(),
+                               minio::utils::Multimap(), queryParams);
+        req.bucket_name = bucket;
+        req.object_name = object;
+
+        minio::s3::Response resp = connection.Client().Execute(req);
+        if (!resp) {
+            result.noSuchUpload = (resp.code == "NoSuchUpload");
+            error = "ListParts失败: " + resp.Error().String();
+            return false;
+        }
+
+        pugi::xml_document doc;
+        if (!doc.load_string(resp.data.c_str())) {
+            error = "ListParts响应解析失败";
+            return false;
+        }
+        pugi::xml_node root = doc.child("ListPartsResult");
+        for (pugi::xml_node node = root.child("Part"); node; node = node.next_sibling("Part")) {
+            minio::s3::Part part;
+            part.number = node.child("PartNumber").text().as_uint();
+            part.etag = TrimEtag(node.child("ETag").text().get());
+            part.size = node.child("Size").text().as_ullong();
+            result.parts.push_back(part);
+        }
+
+        if (!root.child("IsTruncated").text().as_bool()) {
+            return true;
+        }
+        marker = root.child("NextPartNumberMarker").text().as_uint();
+        if (marker == 0) {
+            error = "ListParts响应缺少NextPartNumberMarker";
+            return false;
+        }
+    }
+}
+
+bool ListMultipartUploads(MinioConnection& connection, const std::string& bucket,
+                          const std::string& prefix,
+                          const std::function<bool(const std::vector<MultipartUploadInfo>&)>& onPage,
+                          std::string& error) {
+    std::string region;
+    if (!GetRegion(connection, bucket, region, error)) {
+        return false;
+    }
+
+    // 翻页游标：同一对象可能有多个未完成上传，需要对象名和upload_id一起定位
+    std::string keyMarker;
+    std::string uploadIdMarker;
+    for (;;) {
+        minio::utils::Multimap queryParams;
+        queryParams.Add("uploads", "");
+        queryParams.Add("max-uploads", MAX_UPLOADS_PER_PAGE);
+        if (!prefix.empty()) {
+            queryParams.Add("prefix", prefix);
+        }
+        if (!keyMarker.empty()) {
+            queryParams.Add("key-marker", keyMarker);
+            queryParams.Add("upload-id-marker", uploadIdMarker);
+        }
+
+        minio::s3::Request req(minio::http::Method::kGet, region, connection.Url(),
+                               minio::utils::Multimap(), queryParams);
+        req.bucket_name = bucket;
+
+        minio::s3::Response resp = connection.Client().Execute(req);
+        if (!resp) {
+            error = "ListMultipartUploads失败: " + resp.Error().String();
+            return false;
+        }
+
+        pugi::xml_document doc;
+        if (!doc.load_string(resp.data.c_str())) {
+            error = "ListMultipartUploads响应解析失败";
+            return false;
+        }
+        pugi::xml_node root = doc.child("ListMultipartUploadsResult");
+        std::vector<MultipartUploadInfo> uploads;
+        for (pugi::xml_node node = root.child("Upload"); node; node = node.next_sibling("Upload")) {
+            MultipartUploadInfo upload;
+            upload.object = node.child("Key").text().get();
+            upload.uploadId = node.child("UploadId").text().get();
+            upload.initiated = ParseIso8601(node.child("Initiated").text().get());
+            uploads.push_back(std::move(upload));
+        }
+        if (!uploads.empty() && !onPage(uploads)) {
+            return true;
+        }
+
+        if (!root.child("IsTruncated").text().as_bool()) {
+            return true;
+        }
+        keyMarker = root.child("NextKeyMarker").text().get();
+        uploadIdMarker = root.child("NextUploadIdMarker").text().get();
+        if (keyMarker.empty()) {
+            error = "ListMultipartUploads响应缺少NextKeyMarker";
+            return false;
+        }
+    }
+}
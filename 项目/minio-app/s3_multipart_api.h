@@ -0,0 +1,42 @@
+#pragma once
+
+#include <ctime>
+#include <functional>
+#include <string>
+#include <vector>
+#include <miniocpp/client.h>  // MinIO C++ SDK主要头文件
+
+#include "minio_connection.h"
+
+/**
+ * MinIO C++ SDK未封装的Multipart Upload接口
+ *
+ * SDK提供了Create/UploadPart/Complete/Abort，但没有ListParts、ListMultipartUploads等查询接口。
+ * 这里用Client::Execute()发送原始S3请求，并用SDK自带的pugixml解析XML响应。
+ */
+
+// 去掉ETag两侧的引号：ListParts返回带引号的ETag，UploadPart响应中的ETag不带引号
+std::string TrimEtag(const std::string& etag);
+
+struct ListPartsResult {
+    std::vector<minio::s3::Part> parts;  // 服务端已收到的分块（按编号递增）
+    bool noSuchUpload = false;           // upload_id已不存在（已完成、已中止或已过期）
+};
+
+// 列出upload_id下服务端已有的全部分块（自动翻页）；失败返回false并写入error
+bool ListParts(MinioConnection& connection, const std::string& bucket, const std::string& object,
+               const std::string& uploadId, ListPartsResult& result, std::string& error);
+
+// 服务端未完成（既未Complete也未Abort）的一个Multipart Upload
+struct MultipartUploadInfo {
+    std::string object;
+    std::string uploadId;
+    std::time_t initiated = 0;  // 创建时间（UTC秒），响应中无法解析时为0
+};
+
+// 列出bucket中对象名以prefix开头的全部未完成上传（自动翻页），每页回调一次；
+// 回调返回false时停止翻页。失败返回false并写入error
+bool ListMultipartUploads(MinioConnection& connection, const std::string& bucket,
+                          const std::string& prefix,
+                          const std::function<bool(const std::vector<MultipartUploadInfo>&)>& onPage,
+                          std::string& error);
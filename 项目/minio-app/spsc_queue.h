@@ -0,0 +1,65 @@
+#pragma once
+
+#include <atomic>   // 原子变量，实现无锁读写下标
+#include <cstddef>
+#include <vector>
+
+/**
+ * 无锁单生产者单消费者（SPSC）环形队列
+ *
+ * 功能说明：
+ * 1. 固定容量，构造时一次分配，运行期间不再分配内存
+ * 2. 只允许一个线程TryPush、一个线程TryPop，两端都不加锁
+ * 3. head_/tail_分别放在独立缓存行，避免生产者与消费者之间的伪共享
+ *
+ * 容量向上取整为2的幂，用位与代替取模。
+ */
+template <typename T>
+class SpscQueue {
+public:
+    explicit SpscQueue(size_t capacity) {
+        size_t size = 2;
+        while (size < capacity) {
+            size <<= 1;
+        }
+        slots_.resize(size);
+        mask_ = size - 1;
+    }
+
+    SpscQueue(const SpscQueue&) = delete;
+    SpscQueue& operator=(const SpscQueue&) = delete;
+
+    // 生产者调用；队列满时返回false
+    bool TryPush(const T& value) {
+        const size_t tail = tail_.load(std::memory_order_relaxed);
+        if (tail - head_.load(std::memory_order_acquire) > mask_) {
+            return false;
+        }
+        slots_[tail & mask_] = value;
+        tail_.store(tail + 1, std::memory_order_release);  // 发布：先写槽位再推进tail
+        return true;
+    }
+
+    // 消费者调用；队列空时返回false
+    bool TryPop(T& value) {
+        const size_t head = head_.load(std::memory_order_relaxed);
+        if (head == tail_.load(std::memory_order_acquire)) {
+            return false;
+        }
+        value = slots_[head & mask_];
+        head_.store(head + 1, std::memory_order_release);  // 释放槽位给生产者
+        return true;
+    }
+
+    bool Empty() const {
+        return head_.load(std::memory_order_acquire) == tail_.load(std::memory_order_acquire);
+    }
+
+private:
+    static constexpr size_t CACHE_LINE = 64;
+
+    std::vector<T> slots_;
+    size_t mask_ = 0;
+    alignas(CACHE_LINE) std::atomic<size_t> head_{0};  // 消费者推进
+    alignas(CACHE_LINE) std::atomic<size_t> tail_{0};  // 生产者推进
+};
@@ -0,0 +1,58 @@
+#include "stream_source.h"
+
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>    // open
+#include <unistd.h>   // read, close
+
+StreamSource::~StreamSource() {
+    if (ownsFd_ && fd_ >= 0) {
+        ::close(fd_);
+    }
+}
+
+bool StreamSource::Open(const std::string& path) {
+    if (path == "-") {
+        Attach(STDIN_FILENO);
+        name_ = "标准输入";
+        return true;
+    }
+    int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        lastError_ = "无法打开输入 " + path + ": " + std::strerror(errno);
+        return false;
+    }
+    Attach(fd);
+    ownsFd_ = true;
+    name_ = path;
+    return true;
+}
+
+void StreamSource::Attach(int fd) {
+    fd_ = fd;
+    ownsFd_ = false;
+    eof_ = false;
+    totalRead_ = 0;
+    name_ = "文件描述符 " + std::to_string(fd);
+}
+
+bool StreamSource::ReadFull(char* dest, size_t length, size_t& bytesRead) {
+    bytesRead = 0;
+    while (bytesRead < length && !eof_) {
+        ssize_t n = ::read(fd_, dest + bytesRead, length - bytesRead);
+        if (n < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            lastError_ = "读取" + name_ + "失败: " + std::strerror(errno);
+            return false;
+        }
+        if (n == 0) {
+            eof_ = true;  // 写端已关闭，数据结束
+            break;
+        }
+        bytesRead += static_cast<size_t>(n);
+    }
+    totalRead_ += bytesRead;
+    return true;
+}
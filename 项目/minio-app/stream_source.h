@@ -0,0 +1,59 @@
+#pragma once
+
+#include <cstddef>
+#include <string>
+
+/**
+ * 只能顺序读取的数据源接口：原始输入流，或在其上叠加的处理阶段（如压缩）
+ */
+class SequentialSource {
+public:
+    virtual ~SequentialSource() = default;
+
+    // 读取最多length字节到dest，只有遇到EOF才会少于length；出错返回false
+    virtual bool ReadFull(char* dest, size_t length, size_t& bytesRead) = 0;
+
+    virtual bool Eof() const = 0;
+    // 已输出给调用方的总字节数
+    virtual size_t BytesRead() const = 0;
+    virtual const std::string& Name() const = 0;
+    virtual const std::string& LastError() const = 0;
+};
+
+/**
+ * 长度未知的顺序输入流（标准输入、管道、任意已打开的文件描述符）
+ *
+ * 功能说明：
+ * 1. 只能顺序读取，不能定位，也不预先知道总长度；读到EOF才知道数据结束
+ * 2. ReadFull()循环调用read()直到填满目标区间或遇到EOF：管道每次read只返回
+ *    已写入管道的数据（通常几十KB），不能以一次短读判断分块结束
+ * 3. 调用方以"缓冲区未填满"判断这是最后一段数据，据此决定PutObject还是Multipart Upload
+ */
+class StreamSource : public SequentialSource {
+public:
+    StreamSource() = default;
+    ~StreamSource() override;
+
+    StreamSource(const StreamSource&) = delete;
+    StreamSource& operator=(const StreamSource&) = delete;
+
+    // path为"-"时读取标准输入，否则打开路径（可以是命名管道）；失败返回false
+    bool Open(const std::string& path);
+    // 读取调用方已打开的文件描述符，不接管其关闭
+    void Attach(int fd);
+
+    bool ReadFull(char* dest, size_t length, size_t& bytesRead) override;
+
+    bool Eof() const override { return eof_; }
+    size_t BytesRead() const override { return totalRead_; }
+    const std::string& Name() const override { return name_; }
+    const std::string& LastError() const override { return lastError_; }
+
+private:
+    int fd_ = -1;
+    bool ownsFd_ = false;
+    bool eof_ = false;
+    size_t totalRead_ = 0;
+    std::string name_;
+    std::string lastError_;
+};
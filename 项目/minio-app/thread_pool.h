@@ -0,0 +1,111 @@
+#pragma once
+
+#include <condition_variable>  // 条件变量，用于任务队列的等待/唤醒
+#include <cstddef>
+#include <deque>               // 双端队列，作为任务队列
+#include <functional>          // std::function，封装任务
+#include <mutex>               // 互斥锁，保护任务队列
+#include <thread>              // 工作线程
+#include <vector>
+
+/**
+ * 有界工作线程池
+ *
+ * 功能说明：
+ * 1. 固定数量的工作线程，从共享任务队列中取任务执行
+ * 2. 任务队列有容量上限，队列满时Submit()阻塞 - 形成反压，限制内存中待处理的分块数量
+ * 3. 每个任务执行时会拿到所在工作线程的编号，便于按线程绑定资源（如每线程一个MinIO客户端）
+ *
+ * 使用方式：
+ *   ThreadPool pool(4, 4);
+ *   pool.Submit([](size_t workerIndex) { ... });
+ *   pool.Wait();   // 等待所有已提交任务执行完毕
+ */
+class ThreadPool {
+public:
+    using Task = std::function<void(size_t workerIndex)>;
+
+    // threadCount: 工作线程数量；queueCapacity: 排队任务数量上限（不含正在执行的任务）
+    ThreadPool(size_t threadCount, size_t queueCapacity)
+        : queueCapacity_(queueCapacity == 0 ? 1 : queueCapacity) {
+        if (threadCount == 0) {
+            threadCount = 1;
+        }
+        workers_.reserve(threadCount);
+        for (size_t i = 0; i < threadCount; ++i) {
+            workers_.emplace_back([this, i] { WorkerLoop(i); });
+        }
+    }
+
+    ~ThreadPool() {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            stopping_ = true;
+        }
+        taskReady_.notify_all();
+        spaceReady_.notify_all();
+        for (auto& worker : workers_) {
+            worker.join();
+        }
+    }
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    // 提交任务；队列已满时阻塞，直到有工作线程取走任务
+    void Submit(Task task) {
+        std::unique_lock<std::mutex> lock(mutex_);
+        spaceReady_.wait(lock, [this] { return stopping_ || tasks_.size() < queueCapacity_; });
+        if (stopping_) {
+            return;
+        }
+        tasks_.push_back(std::move(task));
+        taskReady_.notify_one();
+    }
+
+    // 阻塞等待：队列为空且没有正在执行的任务
+    void Wait() {
+        std::unique_lock<std::mutex> lock(mutex_);
+        idle_.wait(lock, [this] { return tasks_.empty() && running_ == 0; });
+    }
+
+    size_t ThreadCount() const { return workers_.size(); }
+
+private:
+    void WorkerLoop(size_t workerIndex) {
+        for (;;) {
+            Task task;
+            {
+                std::unique_lock<std::mutex> lock(mutex_);
+                taskReady_.wait(lock, [this] { return stopping_ || !tasks_.empty(); });
+                if (tasks_.empty()) {
+                    return;  // stopping_且队列已清空，线程退出
+                }
+                task = std::move(tasks_.front());
+                tasks_.pop_front();
+                ++running_;
+            }
+            spaceReady_.notify_one();
+
+            task(workerIndex);
+
+            {
+                std::lock_guard<std::mutex> lock(mutex_);
+                --running_;
+                if (tasks_.empty() && running_ == 0) {
+                    idle_.notify_all();
+                }
+            }
+        }
+    }
+
+    const size_t queueCapacity_;
+    std::vector<std::thread> workers_;
+    std::deque<Task> tasks_;
+    size_t running_ = 0;          // 正在执行的任务数
+    bool stopping_ = false;
+    std::mutex mutex_;
+    std::condition_variable taskReady_;   // 有新任务
+    std::condition_variable spaceReady_;  // 队列有空位
+    std::condition_variable idle_;        // 全部任务完成
+};
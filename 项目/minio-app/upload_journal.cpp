@@ -0,0 +1,158 @@
+#include "upload_journal.h"
+
+#include <cerrno>
+#include <cstdio>      // rename
+#include <cstring>
+#include <fcntl.h>     // open
+#include <fstream>     // 读取日志
+#include <sstream>
+#include <unistd.h>    // write, fdatasync, close, unlink
+
+namespace {
+
+const char* JOURNAL_MAGIC = "minio-upload-journal 1";
+
+}  // namespace
+
+UploadJournal::~UploadJournal() {
+    Close();
+}
+
+bool UploadJournal::Load(const std::string& path, State& state) {
+    std::ifstream in(path);
+    if (!in.is_open()) {
+        return false;
+    }
+
+    std::string line;
+    if (!std::getline(in, line) || line != JOURNAL_MAGIC) {
+        return false;
+    }
+
+    state = State();
+    while (std::getline(in, line)) {
+        size_t space = line.find(' ');
+        if (space == std::string::npos) {
+            continue;  // 崩溃时写了一半的行
+        }
+        std::string key = line.substr(0, space);
+        std::string value = line.substr(space + 1);
+        try {
+            if (key == "bucket") {
+                state.bucket = value;
+            } else if (key == "object") {
+                state.object = value;  // 对象名可能含空格，取整行剩余部分
+            } else if (key == "file_size") {
+                state.fileSize = std::stoull(value);
+            } else if (key == "file_mtime") {
+                state.fileMtime = std::stoll(value);
+            } else if (key == "part_size") {
+                state.partSize = std::stoull(value);
+            } else if (key == "upload_id") {
+                state.uploadId = value;
+            } else if (key == "part") {
+                std::istringstream fields(value);
+                PartRecord record;
+                if (fields >> record.number >> record.size >> record.etag) {
+                    state.parts[record.number] = record;
+                }
+            }
+        } catch (const std::exception&) {
+            continue;  // 数字字段被截断，忽略该行
+        }
+    }
+    return !state.bucket.empty() && !state.object.empty() && !state.uploadId.empty() &&
+           state.partSize > 0;
+}
+
+bool UploadJournal::Create(const std::string& path, const State& header) {
+    Close();
+    path_ = path;
+    // 写临时文件后rename：崩溃时磁盘上要么是旧日志，要么是完整的新日志头，
+    // 不会出现被截断、还没写入新内容的空日志
+    std::string tmpPath = path + ".tmp";
+    fd_ = ::open(tmpPath.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+    if (fd_ < 0) {
+        lastError_ = "无法创建续传日志 " + tmpPath + ": " + std::strerror(errno);
+        return false;
+    }
+
+    std::ostringstream text;
+    text << JOURNAL_MAGIC << "\n"
+         << "bucket " << header.bucket << "\n"
+         << "object " << header.object << "\n"
+         << "file_size " << header.fileSize << "\n"
+         << "file_mtime " << header.fileMtime << "\n"
+         << "part_size " << header.partSize << "\n"
+         << "upload_id " << header.uploadId << "\n";
+    std::lock_guard<std::mutex> lock(mutex_);
+    bool ok = WriteDurably(text.str());
+    if (ok && ::rename(tmpPath.c_str(), path.c_str()) != 0) {
+        lastError_ = "无法替换续传日志 " + path + ": " + std::strerror(errno);
+        ok = false;
+    }
+    if (!ok) {
+        ::close(fd_);
+        fd_ = -1;
+        ::unlink(tmpPath.c_str());
+    }
+    // 成功后fd_指向的就是rename后的日志文件，之后的分块记录直接追加
+    return ok;
+}
+
+bool UploadJournal::OpenForAppend(const std::string& path) {
+    Close();
+    path_ = path;
+    fd_ = ::open(path.c_str(), O_WRONLY | O_APPEND | O_CLOEXEC);
+    if (fd_ < 0) {
+        lastError_ = "无法打开续传日志 " + path + ": " + std::strerror(errno);
+        return false;
+    }
+    // 上次崩溃可能留下不完整的最后一行，先补一个换行，保证新记录独占一行
+    std::lock_guard<std::mutex> lock(mutex_);
+    return WriteDurably("\n");
+}
+
+bool UploadJournal::RecordPart(unsigned int number, size_t size, const std::string& etag) {
+    std::string line = "part " + std::to_string(number) + " " + std::to_string(size) + " " + etag + "\n";
+    std::lock_guard<std::mutex> lock(mutex_);
+    return WriteDurably(line);
+}
+
+void UploadJournal::Remove() {
+    Close();
+    if (!path_.empty()) {
+        ::unlink(path_.c_str());
+    }
+}
+
+bool UploadJournal::WriteDurably(const std::string& text) {
+    if (fd_ < 0) {
+        return false;
+    }
+    size_t written = 0;
+    while (written < text.size()) {
+        ssize_t n = ::write(fd_, text.data() + written, text.size() - written);
+        if (n < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            lastError_ = std::string("写续传日志失败: ") + std::strerror(errno);
+            return false;
+        }
+        written += static_cast<size_t>(n);
+    }
+    // 分块记录必须先落盘：否则崩溃后会丢失已上传分块的ETag
+    if (::fdatasync(fd_) != 0) {
+        lastError_ = std::string("续传日志落盘失败: ") + std::strerror(errno);
+        return false;
+    }
+    return true;
+}
+
+void UploadJournal::Close() {
+    if (fd_ >= 0) {
+        ::close(fd_);
+        fd_ = -1;
+    }
+}
@@ -0,0 +1,82 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <mutex>
+#include <string>
+
+/**
+ * Multipart Upload断点续传日志
+ *
+ * 功能说明：
+ * 1. 在源文件旁的sidecar文件（<源文件>.upload-journal）中记录upload_id、分块大小和源文件标识
+ * 2. 每个分块上传成功后追加一行"part 编号 大小 ETag"并fdatasync，进程崩溃也不会丢失
+ * 3. 重启时读回日志，调用方再与服务端ListParts的结果核对，只补传缺失的分块
+ *
+ * 文件格式（文本，逐行追加）：
+ *   minio-upload-journal 1
+ *   bucket <bucket>
+ *   object <object>
+ *   file_size <源文件大小>
+ *   file_mtime <源文件修改时间>
+ *   part_size <分块大小>
+ *   upload_id <upload_id>
+ *   part <编号> <大小> <ETag>
+ *   ...
+ * 崩溃时最后一行可能不完整，读取时忽略无法解析的行。
+ */
+class UploadJournal {
+public:
+    struct PartRecord {
+        unsigned int number = 0;
+        size_t size = 0;
+        std::string etag;
+    };
+
+    struct State {
+        std::string bucket;
+        std::string object;
+        uint64_t fileSize = 0;
+        int64_t fileMtime = 0;
+        size_t partSize = 0;
+        std::string uploadId;
+        std::map<unsigned int, PartRecord> parts;  // 分块编号 -> 已完成分块
+    };
+
+    UploadJournal() = default;
+    ~UploadJournal();
+
+    UploadJournal(const UploadJournal&) = delete;
+    UploadJournal& operator=(const UploadJournal&) = delete;
+
+    static std::string PathFor(const std::string& sourceFile) {
+        return sourceFile + ".upload-journal";
+    }
+
+    // 读取已有日志；文件不存在或头部不完整返回false
+    static bool Load(const std::string& path, State& state);
+
+    // 新建日志并写入头部：先写临时文件并落盘，再原子替换旧日志
+    bool Create(const std::string& path, const State& header);
+
+    // 打开已有日志，继续追加分块记录
+    bool OpenForAppend(const std::string& path);
+
+    // 记录一个已完成的分块，可在多个上传线程中并发调用
+    bool RecordPart(unsigned int number, size_t size, const std::string& etag);
+
+    // 上传完成后删除日志
+    void Remove();
+
+    const std::string& LastError() const { return lastError_; }
+
+private:
+    bool WriteDurably(const std::string& text);
+    void Close();
+
+    std::string path_;
+    int fd_ = -1;
+    std::mutex mutex_;
+    std::string lastError_;
+};
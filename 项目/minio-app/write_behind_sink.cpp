@@ -0,0 +1,450 @@
+#include "write_behind_sink.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <cstring>
+#include <fcntl.h>      // fallocate
+#include <unistd.h>     // pwrite, ftruncate
+
+#ifdef MINIO_APP_HAVE_LIBURING
+#include <liburing.h>
+
+namespace {
+// 取消请求和作废写入的user_data，与缓冲区下标区分
+void* CancelTag() { return reinterpret_cast<void*>(UINTPTR_MAX); }
+}  // namespace
+#endif
+
+WriteBehindSink::WriteBehindSink(int fd, WriterBackend backend, std::string& warning,
+                                 size_t bufferSize, size_t bufferCount)
+    : fd_(fd), bufferSize_(bufferSize == 0 ? DEFAULT_BUFFER_SIZE : bufferSize) {
+    if (bufferCount < 2) {
+        bufferCount = 2;  // 至少一个接收、一个落盘，否则退化为同步写
+    }
+    slots_.resize(bufferCount);
+    for (size_t i = 0; i < bufferCount; ++i) {
+        slots_[i].buffer = std::make_unique<PartBuffer>(bufferSize_);
+        free_.push_back(i);
+    }
+
+    if (backend == WriterBackend::kUring) {
+#ifdef MINIO_APP_HAVE_LIBURING
+        // 在途写入数不超过缓冲区数，队列深度取缓冲区数即可
+        ring_ = new io_uring;
+        int ret = io_uring_queue_init(static_cast<unsigned>(bufferCount), ring_, 0);
+        if (ret < 0) {
+            warning = std::string("io_uring初始化失败: ") + std::strerror(-ret) + "，退回pwrite";
+            delete ring_;
+            ring_ = nullptr;
+        }
+#else
+        warning = "编译时未找到liburing，io_uring写入不可用，退回pwrite";
+#endif
+    }
+
+    writer_ = std::thread([this] {
+        if (ring_ != nullptr) {
+            UringLoop();
+        } else {
+            PwriteLoop();
+        }
+    });
+}
+
+WriteBehindSink::~WriteBehindSink() {
+    Flush();
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stopping_ = true;
+    }
+    jobReady_.notify_all();
+    writer_.join();
+#ifdef MINIO_APP_HAVE_LIBURING
+    if (ring_ != nullptr) {
+        if (!ringClosed_) {
+            io_uring_queue_exit(ring_);
+        }
+        delete ring_;
+    }
+#endif
+}
+
+bool WriteBehindSink::Preallocate(int fd, uint64_t size, std::string& error) {
+    if (size > 0) {
+        if (::fallocate(fd, 0, 0, static_cast<off_t>(size)) == 0) {
+            return true;
+        }
+        if (errno != EOPNOTSUPP && errno != ENOSYS) {
+            error = std::string("预分配文件空间失败: ") + std::strerror(errno);
+            return false;  // 例如ENOSPC：空间不够时在下载之前就失败
+        }
+    }
+    if (::ftruncate(fd, static_cast<off_t>(size)) != 0) {
+        error = std::string("无法扩展输出文件: ") + std::strerror(errno);
+        return false;
+    }
+    return true;
+}
+
+const char* WriteBehindSink::BackendName() const {
+    return ring_ != nullptr ? "io_uring" : "pwrite";
+}
+
+bool WriteBehindSink::Write(uint64_t offset, const char* data, size_t size) {
+    while (size > 0 && !failed_) {
+        // 与当前缓冲区不连续（例如重试后从别的偏移续传）时先把已有数据交出去
+        if (current_ != kNoSlot) {
+            const Slot& slot = slots_[current_];
+            if (offset != slot.offset + slot.size) {
+                SubmitCurrent();
+            }
+        }
+        if (current_ == kNoSlot) {
+            current_ = AcquireSlot();
+            slots_[current_].offset = offset;
+        }
+
+        Slot& slot = slots_[current_];
+        size_t n = std::min(size, bufferSize_ - slot.size);
+        std::memcpy(slot.buffer->Data() + slot.size, data, n);
+        slot.size += n;
+        data += n;
+        size -= n;
+        offset += n;
+        if (slot.size == bufferSize_) {
+            SubmitCurrent();
+        }
+    }
+    return !failed_;
+}
+
+bool WriteBehindSink::Flush() {
+    if (current_ != kNoSlot) {
+        SubmitCurrent();
+    }
+    std::unique_lock<std::mutex> lock(mutex_);
+    slotFree_.wait(lock, [this] { return pending_.empty() && writing_ == 0; });
+    return !failed_;
+}
+
+WriteBehindSink::Stats WriteBehindSink::GetStats() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return stats_;
+}
+
+std::string WriteBehindSink::LastError() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return lastError_;
+}
+
+size_t WriteBehindSink::AcquireSlot() {
+    std::unique_lock<std::mutex> lock(mutex_);
+    if (free_.empty()) {
+        // 所有缓冲区都在等待落盘：磁盘跟不上网络，只有这里会阻塞接收线程
+        auto start = std::chrono::steady_clock::now();
+        slotFree_.wait(lock, [this] { return !free_.empty(); });
+        stats_.stalls++;
+        stats_.stallSeconds +=
+            std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    }
+    size_t index = free_.front();
+    free_.pop_front();
+    Slot& slot = slots_[index];
+    slot.offset = 0;
+    slot.size = 0;
+    slot.written = 0;
+    return index;
+}
+
+void WriteBehindSink::SubmitCurrent() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (slots_[current_].size > 0) {
+            pending_.push_back(current_);
+        } else {
+            free_.push_back(current_);
+        }
+    }
+    current_ = kNoSlot;
+    jobReady_.notify_one();
+}
+
+void WriteBehindSink::SetError(const std::string& message) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (lastError_.empty()) {
+        lastError_ = message;  // 只保留第一个错误
+    }
+    failed_ = true;
+}
+
+bool WriteBehindSink::TakeJob(size_t& index, bool wait) {
+    std::unique_lock<std::mutex> lock(mutex_);
+    if (wait) {
+        jobReady_.wait(lock, [this] { return stopping_ || !pending_.empty(); });
+    }
+    if (pending_.empty()) {
+        return false;
+    }
+    index = pending_.front();
+    pending_.pop_front();
+    writing_++;
+    return true;
+}
+
+void WriteBehindSink::FinishJob(size_t index) {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stats_.bytesWritten += slots_[index].written;
+        stats_.writes++;
+        writing_--;
+        free_.push_back(index);
+    }
+    slotFree_.notify_all();  // 接收线程和Flush()都可能在等待
+}
+
+size_t WriteBehindSink::NextWrite(const Slot& slot, int& fd) const {
+    size_t remaining = slot.size - slot.written;
+    fd = fd_;
+    // 缓冲区按页对齐，文件偏移和已写长度都对齐时数据地址也对齐
+    if (directFd_ >= 0 && slot.offset % DIRECT_ALIGNMENT == 0 &&
+        slot.written % DIRECT_ALIGNMENT == 0 && remaining >= DIRECT_ALIGNMENT) {
+        fd = directFd_;
+        return remaining / DIRECT_ALIGNMENT * DIRECT_ALIGNMENT;
+    }
+    return remaining;
+}
+
+// ==================== pwrite后端 ====================
+void WriteBehindSink::PwriteLoop() {
+    size_t index;
+    while (TakeJob(index, true)) {
+        Slot& slot = slots_[index];
+        // 出错后不再写入，只归还缓冲区，让接收线程尽快看到失败
+        while (!failed_ && slot.written < slot.size) {
+            int fd;
+            size_t length = NextWrite(slot, fd);
+            ssize_t n = ::pwrite(fd, slot.buffer->Data() + slot.written, length,
+                                 static_cast<off_t>(slot.offset + slot.written));
+            if (n < 0) {
+                if (errno == EINTR) {
+                    continue;
+                }
+                SetError(std::string("写入输出文件失败: ") + std::strerror(errno));
+                break;
+            }
+            slot.written += static_cast<size_t>(n);
+        }
+        FinishJob(index);
+    }
+}
+
+// ==================== io_uring后端 ====================
+void WriteBehindSink::UringLoop() {
+#ifdef MINIO_APP_HAVE_LIBURING
+    auto queue = [this](size_t index) {
+        Slot& slot = slots_[index];
+        int fd;
+        size_t length = NextWrite(slot, fd);
+        io_uring_sqe* sqe = io_uring_get_sqe(ring_);  // 在途数不超过缓冲区数，必有空位
+        io_uring_prep_write(sqe, fd, slot.buffer->Data() + slot.written,
+                            static_cast<unsigned>(length), slot.offset + slot.written);
+        io_uring_sqe_set_data(sqe, reinterpret_cast<void*>(static_cast<uintptr_t>(index)));
+        slot.queued = true;
+        slot.sqe = sqe;
+        unsubmitted_.push_back(index);
+    };
+
+    size_t inflight = 0;
+    for (;;) {
+        // 没有在途写入时阻塞等待新缓冲区，否则只取走已经排队的
+        size_t index;
+        bool queued = false;
+        while (TakeJob(index, inflight == 0 && !queued)) {
+            queue(index);
+            inflight++;
+            queued = true;
+        }
+        if (inflight == 0) {
+            return;  // 正在停止且没有剩余数据
+        }
+        std::string submitError;
+        if (!SubmitQueued(inflight, submitError)) {
+            // 未被内核接收的写入作废，已提交的取消并等待结束；环的状态不再可信，随后关闭
+            SetError(submitError);
+            inflight -= DiscardUnsubmitted();
+            CancelInflight(inflight);
+            CloseRing();
+            break;
+        }
+
+        io_uring_cqe* cqe = nullptr;
+        int ret = io_uring_wait_cqe(ring_, &cqe);
+        if (ret == -EINTR) {
+            continue;
+        }
+        if (ret < 0) {
+            // 内核仍可能在读在途的缓冲区：先取消并等它们结束，再把失败交给Write()/Flush()
+            SetError(std::string("io_uring等待失败: ") + std::strerror(-ret));
+            inflight -= DiscardUnsubmitted();
+            if (!CancelInflight(inflight)) {
+                break;  // 环已关闭，剩余缓冲区只归还不写入
+            }
+            inflight = 0;
+            continue;
+        }
+        void* data = io_uring_cqe_get_data(cqe);
+        if (data == CancelTag()) {
+            io_uring_cqe_seen(ring_, cqe);  // 之前失败时遗留的取消或空操作的完成事件
+            continue;
+        }
+        index = static_cast<size_t>(reinterpret_cast<uintptr_t>(data));
+        int res = cqe->res;
+        io_uring_cqe_seen(ring_, cqe);
+        inflight--;
+
+        Slot& slot = slots_[index];
+        slot.queued = false;
+        if (res == -EINTR || res == -EAGAIN) {
+            res = 0;  // 可重试错误：按未写入处理，下面原样重新提交
+        } else if (res < 0) {
+            SetError(std::string("io_uring写入失败: ") + std::strerror(-res));
+        } else if (res == 0) {
+            SetError("io_uring写入返回0字节");
+        }
+        slot.written += static_cast<size_t>(std::max(res, 0));
+        if (!failed_ && slot.written < slot.size) {
+            queue(index);  // 短写：从断点继续，下一轮提交
+            inflight++;
+            continue;
+        }
+        FinishJob(index);
+    }
+
+    // 环已关闭：之后提交的缓冲区不再写入，直接归还，接收线程和Flush()不会一直等待
+    size_t rest;
+    while (TakeJob(rest, true)) {
+        FinishJob(rest);
+    }
+#endif
+}
+
+bool WriteBehindSink::SubmitQueued(size_t inflight, std::string& error) {
+#ifdef MINIO_APP_HAVE_LIBURING
+    const unsigned int MAX_BUSY_RETRIES = 100;
+    unsigned int busyRetries = 0;
+    while (!unsubmitted_.empty()) {
+        int ret = io_uring_submit(ring_);
+        if (ret > 0) {
+            // 内核按顺序接收SQE，未接收的留在提交队列中，下次提交时继续
+            size_t accepted = std::min(static_cast<size_t>(ret), unsubmitted_.size());
+            unsubmitted_.erase(unsubmitted_.begin(), unsubmitted_.begin() + accepted);
+            continue;
+        }
+        if (ret == -EINTR) {
+            continue;
+        }
+        if (ret == 0 || ret == -EAGAIN || ret == -EBUSY) {
+            // 内核暂时无法接收：有已提交的写入在途时先回收完成事件，下一轮再提交
+            if (inflight > unsubmitted_.size()) {
+                return true;
+            }
+            if (++busyRetries <= MAX_BUSY_RETRIES) {
+                std::this_thread::sleep_for(std::chrono::milliseconds(1));
+                continue;
+            }
+        }
+        error = std::string("io_uring提交失败: ") + std::strerror(ret < 0 ? -ret : EAGAIN);
+        return false;
+    }
+#else
+    (void)inflight;
+    (void)error;
+#endif
+    return true;
+}
+
+size_t WriteBehindSink::DiscardUnsubmitted() {
+    size_t discarded = unsubmitted_.size();
+#ifdef MINIO_APP_HAVE_LIBURING
+    // 改成空操作后即使之后被提交也不会再读缓冲区，缓冲区可以立即归还
+    for (size_t index : unsubmitted_) {
+        io_uring_prep_nop(slots_[index].sqe);
+        io_uring_sqe_set_data(slots_[index].sqe, CancelTag());
+        slots_[index].queued = false;
+        FinishJob(index);
+    }
+#endif
+    unsubmitted_.clear();
+    return discarded;
+}
+
+void WriteBehindSink::CloseRing() {
+#ifdef MINIO_APP_HAVE_LIBURING
+    if (!ringClosed_) {
+        io_uring_queue_exit(ring_);
+        ringClosed_ = true;
+    }
+#endif
+}
+
+bool WriteBehindSink::CancelInflight(size_t inflight) {
+#ifdef MINIO_APP_HAVE_LIBURING
+    for (size_t i = 0; i < slots_.size(); ++i) {
+        if (!slots_[i].queued) {
+            continue;
+        }
+        // 作废的写入仍占着提交队列，取消请求与它们合计不超过缓冲区数
+        io_uring_sqe* sqe = io_uring_get_sqe(ring_);
+        if (sqe == nullptr) {
+            break;
+        }
+        io_uring_prep_cancel(sqe, reinterpret_cast<void*>(static_cast<uintptr_t>(i)), 0);
+        io_uring_sqe_set_data(sqe, CancelTag());
+    }
+    // 提交失败时只能等写入自然结束；取消请求留在队列里，环的状态不再可信，最后关闭
+    bool submitted = io_uring_submit(ring_) >= 0;
+
+    // 写入结束（完成或被取消）后归还缓冲区；已失败，不再补写短写的剩余部分
+    const unsigned int MAX_WAIT_FAILURES = 5;
+    unsigned int failures = 0;
+    while (inflight > 0 && failures < MAX_WAIT_FAILURES) {
+        __kernel_timespec timeout = {1, 0};
+        io_uring_cqe* cqe = nullptr;
+        int ret = io_uring_wait_cqe_timeout(ring_, &cqe, &timeout);
+        if (ret < 0) {
+            if (ret != -EINTR) {
+                failures++;
+            }
+            continue;
+        }
+        void* data = io_uring_cqe_get_data(cqe);
+        int res = cqe->res;
+        io_uring_cqe_seen(ring_, cqe);
+        if (data == CancelTag()) {
+            continue;
+        }
+        size_t index = static_cast<size_t>(reinterpret_cast<uintptr_t>(data));
+        slots_[index].queued = false;
+        slots_[index].written += static_cast<size_t>(std::max(res, 0));
+        inflight--;
+        FinishJob(index);
+    }
+    if (inflight == 0 && submitted) {
+        return true;
+    }
+
+    // 仍有写入没有结束：关闭环，由内核在销毁环时取消剩余请求，再归还这些缓冲区
+    CloseRing();
+    for (size_t i = 0; i < slots_.size(); ++i) {
+        if (slots_[i].queued) {
+            slots_[i].queued = false;
+            FinishJob(i);
+        }
+    }
+    return false;
+#else
+    (void)inflight;
+    return true;
+#endif
+}
@@ -0,0 +1,136 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "part_buffer.h"
+
+struct io_uring;  // liburing的环结构，避免在头文件中引入liburing
+struct io_uring_sqe;
+
+/**
+ * 合并写入、后台落盘的下载数据接收器
+ *
+ * 功能说明：
+ * 1. SDK的datafunc每次只交来几KB到几十KB的数据，直接写文件会让curl接收线程频繁陷入
+ *    系统调用、并在磁盘变慢时停止收包；接收器先把数据拷进大块的页对齐缓冲区
+ * 2. 缓冲区写满（或下一段数据与当前缓冲区不连续）时交给后台写线程，按偏移整块写入；
+ *    接收线程立即换一个空闲缓冲区继续接收，不等待磁盘
+ * 3. 写后端可选pwrite或io_uring（多个缓冲区同时在途，需编译时找到liburing）
+ * 4. 只有所有缓冲区都在等待落盘时接收线程才会阻塞，阻塞的次数和总时长计入统计，
+ *    用来判断磁盘是否跟不上网络
+ * 5. 缓冲区从BufferPool借出；后台写入出错后，之后的Write()/Flush()都返回false；
+ *    io_uring提交或等待失败时先作废未提交的写入、取消在途写入，等内核放开缓冲区再归还，
+ *    不终止进程；提交遇到-EAGAIN/-EBUSY时先回收完成事件再重试
+ * 6. 可选O_DIRECT：另给一个以O_DIRECT打开的同一文件的描述符，缓冲区中偏移和长度按4KB对齐的
+ *    部分经它写入、绕过页缓存，首尾不对齐的零头仍走普通描述符
+ *
+ * Write()和Flush()只能由同一个线程调用；文件描述符由调用方打开和关闭，
+ * 关闭前须调用Flush()或销毁接收器。
+ */
+enum class WriterBackend {
+    kPwrite,  // 可移植的pwrite
+    kUring,   // io_uring，多个缓冲区同时写
+};
+
+class WriteBehindSink {
+public:
+    struct Stats {
+        size_t bytesWritten = 0;   // 已写入文件的字节数
+        size_t writes = 0;         // 整块写入次数
+        size_t stalls = 0;         // 接收线程等待空闲缓冲区的次数
+        double stallSeconds = 0;   // 接收线程等待空闲缓冲区的总时长
+    };
+
+    static constexpr size_t DEFAULT_BUFFER_SIZE = 1024 * 1024;
+    static constexpr size_t DEFAULT_BUFFER_COUNT = 4;
+    static constexpr size_t DIRECT_ALIGNMENT = 4096;
+
+    // io_uring不可用时退回pwrite，并把原因写入warning
+    WriteBehindSink(int fd, WriterBackend backend, std::string& warning,
+                    size_t bufferSize = DEFAULT_BUFFER_SIZE,
+                    size_t bufferCount = DEFAULT_BUFFER_COUNT);
+    // 写完已接收的数据后退出写线程
+    ~WriteBehindSink();
+
+    WriteBehindSink(const WriteBehindSink&) = delete;
+    WriteBehindSink& operator=(const WriteBehindSink&) = delete;
+
+    // 用fallocate一次分配size字节的文件空间并把文件扩展到size，避免边写边增长造成的extent碎片；
+    // 文件系统不支持fallocate时退回ftruncate
+    static bool Preallocate(int fd, uint64_t size, std::string& error);
+
+    // 设置以O_DIRECT打开的同一文件的描述符，须在第一次Write()之前调用；调用方负责关闭
+    void SetDirectFd(int directFd) { directFd_ = directFd; }
+
+    // 把data写到文件的offset处；与上一次写入首尾相接时合并到同一个缓冲区
+    bool Write(uint64_t offset, const char* data, size_t size);
+    // 提交未满的缓冲区并等待所有数据写入文件
+    bool Flush();
+
+    const char* BackendName() const;
+    Stats GetStats() const;
+    std::string LastError() const;
+
+private:
+    struct Slot {
+        std::unique_ptr<PartBuffer> buffer;
+        uint64_t offset = 0;  // 缓冲区数据在文件中的偏移
+        size_t size = 0;      // 有效字节数
+        size_t written = 0;   // 已写入的字节数（短写时继续）
+        bool queued = false;  // io_uring：已排队或已提交给内核、尚未收到完成事件
+        io_uring_sqe* sqe = nullptr;  // io_uring：最近一次排队使用的SQE，提交失败时据此作废
+    };
+
+    size_t AcquireSlot();
+    void SubmitCurrent();
+    void SetError(const std::string& message);
+    // 写线程：等待下一个待写缓冲区，没有更多任务且正在停止时返回false
+    bool TakeJob(size_t& index, bool wait);
+    // 写线程：缓冲区写完（或放弃）后归还
+    void FinishJob(size_t index);
+    // 缓冲区剩余数据的下一次写入：返回长度，fd为应使用的描述符
+    size_t NextWrite(const Slot& slot, int& fd) const;
+    void PwriteLoop();
+    void UringLoop();
+    // 提交已排队的写入；内核暂时无法接收时视情况先回收完成事件或短暂等待，
+    // 最终失败返回false并写入error
+    bool SubmitQueued(size_t inflight, std::string& error);
+    // 把还没被内核接收的写入改成空操作并归还缓冲区，返回作废的写入数
+    size_t DiscardUnsubmitted();
+    // io_uring等待或提交失败后：取消在途写入并等它们结束，归还缓冲区；返回false表示没能确认
+    // 全部结束，环已关闭
+    bool CancelInflight(size_t inflight);
+    void CloseRing();
+
+    const int fd_;
+    int directFd_ = -1;
+    const size_t bufferSize_;
+    io_uring* ring_ = nullptr;  // 非空表示使用io_uring后端
+    bool ringClosed_ = false;   // 取消失败后写线程已关闭环，析构时不再关闭
+    std::vector<size_t> unsubmitted_;  // 写线程：已排队、尚未被内核接收的缓冲区，按排队顺序
+    std::vector<Slot> slots_;
+    static constexpr size_t kNoSlot = static_cast<size_t>(-1);
+    size_t current_ = kNoSlot;  // 接收线程正在填充的缓冲区
+
+    mutable std::mutex mutex_;
+    std::condition_variable slotFree_;     // 写线程归还缓冲区
+    std::condition_variable jobReady_;     // 接收线程提交缓冲区
+    std::deque<size_t> free_;              // 空闲缓冲区
+    std::deque<size_t> pending_;           // 等待写入的缓冲区
+    size_t writing_ = 0;                   // 写线程已取走、尚未写完的缓冲区数
+    bool stopping_ = false;
+    std::atomic<bool> failed_{false};
+    std::string lastError_;
+    Stats stats_;
+
+    std::thread writer_;
+};